@@ -0,0 +1,1035 @@
+#include <SDL3/SDL.h>
+
+#include "BrickGrid.hpp"
+#include "CircleMeshCache.hpp"
+#include "CollisionKernels.hpp"
+#include "GeometryEngine.hpp"
+#include "LevelController.hpp"
+#include "LevelFactory.hpp"
+#include "Renderer.hpp"
+#include "RewindBuffer.hpp"
+#include "gameobjects/BrickStore.hpp"
+#include "gameobjects/Level.hpp"
+#include "gameobjects/LevelMotion.hpp"
+#include "gameobjects/LevelSnapshot.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// Every C++ heap allocation of the benchmark goes through here, so the allocation checks can count them.
+// The benchmark is single threaded, a plain counter is enough.
+static Uint64 g_heapAllocationCount = 0;
+
+void*
+operator new(size_t a_size)
+{
+    g_heapAllocationCount++;
+    void* memory_p = std::malloc(a_size > 0 ? a_size : 1);
+    if (!memory_p)
+    {
+        throw std::bad_alloc();
+    }
+    return memory_p;
+}
+
+void
+operator delete(void* a_memory_p) noexcept
+{
+    std::free(a_memory_p);
+}
+
+void
+operator delete(void* a_memory_p, size_t) noexcept
+{
+    std::free(a_memory_p);
+}
+
+namespace
+{
+
+const int BrickFieldColumns = 100;
+const int BrickFieldRows = 100;
+const float BrickWidth = 20.0f;
+const float BrickHeight = 10.0f;
+const float BrickGridCellSize = 40.0f;
+const int Repetitions = 5;
+
+const int CircleCount = 1000;
+const float CircleRadius = 15.0f;
+const int OldCircleSegments = 32;
+const int CircleFrames = 100;
+
+const int WarmUpFrames = 2;
+const int SteadyFrames = 200;
+
+// Inputs of the geometry kernels are cycled through so the calls cannot be hoisted out of the loops
+const int GeometryInputCount = 4096;
+const int GeometryCalls = 4000000;
+const SDL_FRect CollisionRect{100.0f, 100.0f, 70.0f, 35.0f};
+const float CollisionBallRadius = 15.0f;
+
+const int GeneratedLevelBrickCounts[] = {35, 1000, 10000, 100000};
+const int IterateExtraBalls = 7;
+const float IterateTickSeconds = 1.0f / 120.0f;
+const int IterateWarmUpTicks = 240;
+const int IterateMeasuredTicks = 5000;
+
+const int CreateLevelCalls = 20000;
+
+const int RestartGeneratedBrickCount = 100000;
+const int RestartCalls = 200;
+
+const int SnapshotGeneratedBrickCount = 1000;
+const int SnapshotCalls = 100000;
+const int SnapshotReplayTicks = 600;
+
+const Uint32 StressLevelBrickCounts[] = {10000, 100000, 1000000, 4000000};
+const int StressLevelRuns = 5;
+
+const char* const BenchmarkLevelPath = "arkanoid_benchmark.level";
+const int LevelFileSizes[] = {7, 100};
+const int LevelLoadCalls = 1000;
+
+struct BenchmarkResult
+{
+    std::string benchmark;
+    std::string variant;
+    std::string metric;
+    double value;
+};
+
+double
+secondsSince(const Uint64 a_startCounter)
+{
+    return (double)(SDL_GetPerformanceCounter() - a_startCounter) / (double)SDL_GetPerformanceFrequency();
+}
+
+void
+addResult(std::vector<BenchmarkResult>& a_results, const char* a_benchmark, const std::string& a_variant, const char* a_metric, const double a_value)
+{
+    a_results.push_back({a_benchmark, a_variant, a_metric, a_value});
+}
+
+// One result per line with a fixed column order, so the files of two builds diff line by line
+bool
+writeResultsCsv(const char* a_path, const std::vector<BenchmarkResult>& a_results)
+{
+    SDL_IOStream* stream_p = SDL_IOFromFile(a_path, "w");
+    if (!stream_p)
+    {
+        SDL_Log("Couldn't open %s: %s", a_path, SDL_GetError());
+        return false;
+    }
+
+    SDL_IOprintf(stream_p, "benchmark,variant,metric,value\n");
+    for (const BenchmarkResult& result : a_results)
+    {
+        SDL_IOprintf(stream_p, "%s,%s,%s,%.6g\n", result.benchmark.c_str(), result.variant.c_str(), result.metric.c_str(), result.value);
+    }
+
+    if (!SDL_CloseIO(stream_p))
+    {
+        SDL_Log("Couldn't write %s: %s", a_path, SDL_GetError());
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<Brick>
+createBrickField(SDL_FRect& a_bounds)
+{
+    a_bounds = {0.0f, 0.0f, BrickFieldColumns * BrickWidth, BrickFieldRows * BrickHeight};
+
+    std::vector<Brick> bricks;
+    bricks.reserve(BrickFieldColumns * BrickFieldRows);
+    for (int row = 0; row < BrickFieldRows; row++)
+    {
+        for (int column = 0; column < BrickFieldColumns; column++)
+        {
+            Brick brick;
+            brick.geometry.properties.isSolid = true;
+            brick.geometry.properties.isVisible = true;
+            brick.geometry.rect = {column * BrickWidth, row * BrickHeight, BrickWidth, BrickHeight};
+            brick.kind = (BrickKind)((row + column) % 3);
+            bricks.push_back(brick);
+        }
+    }
+
+    return bricks;
+}
+
+// Clears the whole field in a random order, once by erasing from a vector (the old storage)
+// and once by marking bricks dead in the BrickStore and removing them from the grid
+void
+benchmarkBrickRemoval(std::vector<BenchmarkResult>& a_results)
+{
+    SDL_FRect bounds;
+    const std::vector<Brick> bricks = createBrickField(bounds);
+
+    std::vector<Uint32> removalOrder(bricks.size());
+    for (Uint32 i = 0; i < removalOrder.size(); i++)
+    {
+        removalOrder[i] = i;
+    }
+    std::shuffle(removalOrder.begin(), removalOrder.end(), std::mt19937(1234));
+
+    double eraseSeconds = 0.0;
+    double tombstoneSeconds = 0.0;
+    for (int repetition = 0; repetition < Repetitions; repetition++)
+    {
+        std::vector<Brick> brickVector = bricks;
+
+        Uint64 startCounter = SDL_GetPerformanceCounter();
+        for (const Uint32 brickIndex : removalOrder)
+        {
+            // Erasing shifts the later bricks, so just pick a random position among the remaining ones
+            brickVector.erase(brickVector.begin() + brickIndex % brickVector.size());
+        }
+        eraseSeconds += secondsSince(startCounter);
+
+        BrickStore brickStore;
+        for (const Brick& brick : bricks)
+        {
+            brickStore.Add(brick);
+        }
+        BrickGrid brickGrid;
+        brickGrid.Build(bounds, BrickGridCellSize, brickStore);
+
+        startCounter = SDL_GetPerformanceCounter();
+        for (const Uint32 brickIndex : removalOrder)
+        {
+            brickGrid.Remove(brickIndex, brickStore.Rect(brickIndex));
+            brickStore.Remove(brickIndex);
+        }
+        tombstoneSeconds += secondsSince(startCounter);
+
+        if (!brickVector.empty() || !brickStore.Empty())
+        {
+            SDL_Log("brick removal: field was not cleared");
+        }
+    }
+
+    SDL_Log("brick removal, %d bricks: vector erase %.3f ms, tombstone %.3f ms (%.1fx)",
+            (int)bricks.size(),
+            eraseSeconds * 1000.0 / Repetitions,
+            tombstoneSeconds * 1000.0 / Repetitions,
+            eraseSeconds / tombstoneSeconds);
+
+    addResult(a_results, "brick_removal", "vector_erase", "ms", eraseSeconds * 1000.0 / Repetitions);
+    addResult(a_results, "brick_removal", "tombstone", "ms", tombstoneSeconds * 1000.0 / Repetitions);
+}
+
+// Builds the vertex data for a frame full of balls, once the way renderCircle used to (sin/cos per rim
+// point, unindexed triangle list) and once through the CircleMeshCache batch
+void
+benchmarkCircleMeshes(std::vector<BenchmarkResult>& a_results)
+{
+    const SDL_FColor color{1.0f, 1.0f, 1.0f, 1.0f};
+    std::vector<SDL_FPoint> centers;
+    for (int i = 0; i < CircleCount; i++)
+    {
+        centers.push_back({(float)(i % 40) * 15.0f, (float)(i / 40) * 15.0f});
+    }
+
+    std::vector<SDL_Vertex> triangleList(OldCircleSegments * 3);
+    double checksum = 0.0;
+
+    Uint64 startCounter = SDL_GetPerformanceCounter();
+    for (int frame = 0; frame < CircleFrames; frame++)
+    {
+        for (const SDL_FPoint& center : centers)
+        {
+            for (int i = 0; i < OldCircleSegments; i++)
+            {
+                const float theta = (float)i / (float)OldCircleSegments * 2.0f * SDL_PI_F;
+                triangleList[i * 3].position = {center.x + CircleRadius * SDL_cosf(theta), center.y + CircleRadius * SDL_sinf(theta)};
+                triangleList[i * 3].color = color;
+                triangleList[i * 3 + 1].position = center;
+                triangleList[i * 3 + 1].color = color;
+
+                const int prevIndex = (i == 0) ? (OldCircleSegments - 1) : i - 1;
+                triangleList[prevIndex * 3 + 2] = triangleList[i * 3];
+            }
+            checksum += triangleList[5].position.x;
+        }
+    }
+    const double triangleListSeconds = secondsSince(startCounter);
+
+    CircleMeshCache circleMeshCache;
+    startCounter = SDL_GetPerformanceCounter();
+    for (int frame = 0; frame < CircleFrames; frame++)
+    {
+        circleMeshCache.Clear(1.0f);
+        for (const SDL_FPoint& center : centers)
+        {
+            circleMeshCache.Add(center, CircleRadius, color);
+        }
+        checksum += circleMeshCache.Vertices()[5].position.x;
+    }
+    const double cachedSeconds = secondsSince(startCounter);
+
+    SDL_Log("circle meshes, %d circles of radius %.0f: trig triangle list %.3f ms/frame (%d vertices, %d calls), "
+            "cached fan %.3f ms/frame (%d vertices, %d indices, 1 call) (%.1fx) [checksum %.0f]",
+            CircleCount, CircleRadius,
+            triangleListSeconds * 1000.0 / CircleFrames, CircleCount * OldCircleSegments * 3, CircleCount,
+            cachedSeconds * 1000.0 / CircleFrames, circleMeshCache.VertexCount(), circleMeshCache.IndexCount(),
+            triangleListSeconds / cachedSeconds, checksum);
+
+    addResult(a_results, "circle_meshes", "trig_triangle_list", "ms_per_frame", triangleListSeconds * 1000.0 / CircleFrames);
+    addResult(a_results, "circle_meshes", "cached_fan", "ms_per_frame", cachedSeconds * 1000.0 / CircleFrames);
+}
+
+// Renders level frames off-screen with the software renderer. Once the first frames have filled the
+// caches, a frame where nothing changed must not touch the C++ heap, and neither may a score change or
+// a frame interpolated between two simulation states. Returns false when the check fails.
+bool
+benchmarkLevelFrameAllocations(std::vector<BenchmarkResult>& a_results)
+{
+    Renderer renderer;
+    if (renderer.InitOffscreen() != SDL_APP_CONTINUE)
+    {
+        SDL_Log("level frame allocations: skipped, no off-screen renderer");
+        return true;
+    }
+
+    Level level = LevelFactory().CreateLevel(renderer.LevelBounds());
+    for (int frame = 0; frame < WarmUpFrames; frame++)
+    {
+        renderer.RenderLevel(level);
+    }
+
+    Uint64 allocationsBefore = g_heapAllocationCount;
+    const Uint64 startCounter = SDL_GetPerformanceCounter();
+    for (int frame = 0; frame < SteadyFrames; frame++)
+    {
+        renderer.RenderLevel(level);
+    }
+    const double steadySeconds = secondsSince(startCounter);
+    const Uint64 steadyAllocations = g_heapAllocationCount - allocationsBefore;
+
+    allocationsBefore = g_heapAllocationCount;
+    level.score += 100;
+    level.paused = true;
+    renderer.RenderLevel(level);
+    const Uint64 hudChangeAllocations = g_heapAllocationCount - allocationsBefore;
+
+    // Every frame at a different point between the two states, as when rendering at the display refresh
+    level.paused = false;
+    LevelMotion motion;
+    motion.previousPadPosition = {level.pad.geometry.rect.x - 10.0f, level.pad.geometry.rect.y};
+    for (const Ball& ball : level.ballsInPlay)
+    {
+        motion.previousBallCenters.push_back({ball.geometry.center.x - 5.0f, ball.geometry.center.y + 5.0f});
+    }
+    renderer.RenderLevel(level, motion, 0.0f);
+
+    allocationsBefore = g_heapAllocationCount;
+    const Uint64 interpolatedStartCounter = SDL_GetPerformanceCounter();
+    for (int frame = 0; frame < SteadyFrames; frame++)
+    {
+        renderer.RenderLevel(level, motion, (float)frame / SteadyFrames);
+    }
+    const double interpolatedSeconds = secondsSince(interpolatedStartCounter);
+    const Uint64 interpolatedAllocations = g_heapAllocationCount - allocationsBefore;
+
+    const bool passed = steadyAllocations == 0 && hudChangeAllocations == 0 && interpolatedAllocations == 0;
+    SDL_Log("level frames: %.3f ms/frame steady, %.3f ms/frame interpolated (240 FPS needs %.3f ms), heap allocations: %llu in %d steady frames, %llu on a HUD change, %llu in %d interpolated frames - %s",
+            steadySeconds * 1000.0 / SteadyFrames,
+            interpolatedSeconds * 1000.0 / SteadyFrames,
+            1000.0 / 240.0,
+            (unsigned long long)steadyAllocations, SteadyFrames,
+            (unsigned long long)hudChangeAllocations,
+            (unsigned long long)interpolatedAllocations, SteadyFrames,
+            passed ? "ok" : "FAILED");
+
+    addResult(a_results, "level_frames", "steady", "ms_per_frame", steadySeconds * 1000.0 / SteadyFrames);
+    addResult(a_results, "level_frames", "steady", "heap_allocations", (double)steadyAllocations);
+    addResult(a_results, "level_frames", "hud_change", "heap_allocations", (double)hudChangeAllocations);
+    addResult(a_results, "level_frames", "interpolated", "ms_per_frame", interpolatedSeconds * 1000.0 / SteadyFrames);
+    addResult(a_results, "level_frames", "interpolated", "heap_allocations", (double)interpolatedAllocations);
+
+    return passed;
+}
+
+RectGeometry
+createCollisionRect()
+{
+    RectGeometry rect;
+    rect.properties.isSolid = true;
+    rect.properties.isVisible = true;
+    rect.rect = CollisionRect;
+    return rect;
+}
+
+// Balls around CollisionRect moving towards its center. Hits overlap an edge by half their radius,
+// misses are at least one radius away from the rect and inside balls have their center in the rect.
+enum class CollisionCase
+{
+    Hit,
+    Miss,
+    Inside
+};
+
+std::vector<CircleGeometry>
+createCollisionBalls(const CollisionCase a_case)
+{
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const SDL_FPoint rectCenter{CollisionRect.x + CollisionRect.w / 2.0f, CollisionRect.y + CollisionRect.h / 2.0f};
+
+    std::vector<CircleGeometry> balls(GeometryInputCount);
+    for (CircleGeometry& ball : balls)
+    {
+        ball.properties.isSolid = true;
+        ball.properties.isVisible = true;
+        ball.radius = CollisionBallRadius;
+
+        switch (a_case)
+        {
+        case CollisionCase::Hit:
+        {
+            // A random point on a random edge, pushed out by half the radius
+            const int edge = (int)(unit(random) * 4.0f) % 4;
+            const float along = unit(random);
+            const float offset = CollisionBallRadius * 0.5f;
+            if (edge == 0)
+            {
+                ball.center = {CollisionRect.x - offset, CollisionRect.y + along * CollisionRect.h};
+            }
+            else if (edge == 1)
+            {
+                ball.center = {CollisionRect.x + CollisionRect.w + offset, CollisionRect.y + along * CollisionRect.h};
+            }
+            else if (edge == 2)
+            {
+                ball.center = {CollisionRect.x + along * CollisionRect.w, CollisionRect.y - offset};
+            }
+            else
+            {
+                ball.center = {CollisionRect.x + along * CollisionRect.w, CollisionRect.y + CollisionRect.h + offset};
+            }
+            break;
+        }
+
+        case CollisionCase::Miss:
+        {
+            const float angle = unit(random) * 2.0f * SDL_PI_F;
+            const float distance = CollisionRect.w + CollisionBallRadius * (1.0f + unit(random) * 4.0f);
+            ball.center = {rectCenter.x + SDL_cosf(angle) * distance, rectCenter.y + SDL_sinf(angle) * distance};
+            break;
+        }
+
+        case CollisionCase::Inside:
+            ball.center = {CollisionRect.x + unit(random) * CollisionRect.w, CollisionRect.y + unit(random) * CollisionRect.h};
+            break;
+        }
+
+        const SDL_FPoint towardsCenter{rectCenter.x - ball.center.x, rectCenter.y - ball.center.y};
+        const float length = SDL_max(SDL_sqrtf(towardsCenter.x * towardsCenter.x + towardsCenter.y * towardsCenter.y), 1.0f);
+        ball.properties.velocity = SDL_FPoint{towardsCenter.x / length * Constants::StartingBallSpeed, towardsCenter.y / length * Constants::StartingBallSpeed};
+    }
+
+    return balls;
+}
+
+const char*
+collisionCaseName(const CollisionCase a_case)
+{
+    switch (a_case)
+    {
+    case CollisionCase::Hit:
+        return "hit";
+
+    case CollisionCase::Miss:
+        return "miss";
+
+    case CollisionCase::Inside:
+        return "inside";
+    }
+
+    return "unknown";
+}
+
+// Ball sized moving rects at the ball positions, for the rect against rect kernel
+std::vector<RectGeometry>
+createCollisionRects(const std::vector<CircleGeometry>& a_balls)
+{
+    std::vector<RectGeometry> rects(a_balls.size());
+    for (size_t i = 0; i < a_balls.size(); i++)
+    {
+        const CircleGeometry& ball = a_balls[i];
+        rects[i].properties = ball.properties;
+        rects[i].rect = {ball.center.x - ball.radius, ball.center.y - ball.radius, ball.radius * 2.0f, ball.radius * 2.0f};
+    }
+    return rects;
+}
+
+// Throughput of the collision kernels, once through GeometryEngine::ProcessCollision, which picks the
+// response from the solid flags and the velocity on every call, and once through the CollisionKernels
+// instance the level controller resolves at compile time. The colliding shapes get moved, so every call
+// works on a fresh copy of its input.
+void
+benchmarkCollisionKernels(std::vector<BenchmarkResult>& a_results)
+{
+    const GeometryEngine geometryEngine;
+    const CollisionCase cases[] = {CollisionCase::Hit, CollisionCase::Miss, CollisionCase::Inside};
+    double checksum = 0.0;
+
+    for (const CollisionCase collisionCase : cases)
+    {
+        const std::vector<CircleGeometry> balls = createCollisionBalls(collisionCase);
+        RectGeometry rect = createCollisionRect();
+
+        Uint64 startCounter = SDL_GetPerformanceCounter();
+        int insideCount = 0;
+        for (int call = 0; call < GeometryCalls; call++)
+        {
+            bool isInside;
+            const SDL_FPoint closestPoint = geometryEngine.GetClosestPointOnRect(balls[call & (GeometryInputCount - 1)], rect, isInside);
+            checksum += closestPoint.x + closestPoint.y;
+            insideCount += isInside ? 1 : 0;
+        }
+        const double closestPointSeconds = secondsSince(startCounter);
+
+        startCounter = SDL_GetPerformanceCounter();
+        int collisionCount = 0;
+        for (int call = 0; call < GeometryCalls; call++)
+        {
+            CircleGeometry ball = balls[call & (GeometryInputCount - 1)];
+            SDL_FPoint contactPoint{0.0f, 0.0f};
+            collisionCount += geometryEngine.ProcessCollision(ball, rect, &contactPoint) ? 1 : 0;
+            checksum += contactPoint.x + ball.center.y;
+        }
+        const double collisionSeconds = secondsSince(startCounter);
+
+        startCounter = SDL_GetPerformanceCounter();
+        int kernelCollisionCount = 0;
+        for (int call = 0; call < GeometryCalls; call++)
+        {
+            CircleGeometry ball = balls[call & (GeometryInputCount - 1)];
+            SDL_FPoint contactPoint{0.0f, 0.0f};
+            kernelCollisionCount += CollisionKernels::CircleRect<MovingSolidBody, StaticSolidBody>(ball, rect.rect, &contactPoint) ? 1 : 0;
+            checksum += contactPoint.x + ball.center.y;
+        }
+        const double kernelSeconds = secondsSince(startCounter);
+
+        // Neighbouring balls of the case against each other
+        startCounter = SDL_GetPerformanceCounter();
+        int circleCircleCount = 0;
+        for (int call = 0; call < GeometryCalls; call++)
+        {
+            CircleGeometry ball = balls[call & (GeometryInputCount - 1)];
+            CircleGeometry other = balls[(call + 1) & (GeometryInputCount - 1)];
+            circleCircleCount += geometryEngine.ProcessCollision(ball, other, nullptr) ? 1 : 0;
+            checksum += ball.center.x + other.center.y;
+        }
+        const double circleCircleSeconds = secondsSince(startCounter);
+
+        startCounter = SDL_GetPerformanceCounter();
+        for (int call = 0; call < GeometryCalls; call++)
+        {
+            CircleGeometry ball = balls[call & (GeometryInputCount - 1)];
+            CircleGeometry other = balls[(call + 1) & (GeometryInputCount - 1)];
+            CollisionKernels::CircleCircle<MovingSolidBody, MovingSolidBody>(ball, other, nullptr);
+            checksum += ball.center.x + other.center.y;
+        }
+        const double circleCircleKernelSeconds = secondsSince(startCounter);
+
+        const std::vector<RectGeometry> movingRects = createCollisionRects(balls);
+        startCounter = SDL_GetPerformanceCounter();
+        int rectRectCount = 0;
+        for (int call = 0; call < GeometryCalls; call++)
+        {
+            RectGeometry movingRect = movingRects[call & (GeometryInputCount - 1)];
+            SDL_FPoint contactPoint{0.0f, 0.0f};
+            rectRectCount += geometryEngine.ProcessCollision(movingRect, rect, &contactPoint) ? 1 : 0;
+            checksum += contactPoint.x + movingRect.rect.y;
+        }
+        const double rectRectSeconds = secondsSince(startCounter);
+
+        startCounter = SDL_GetPerformanceCounter();
+        for (int call = 0; call < GeometryCalls; call++)
+        {
+            RectGeometry movingRect = movingRects[call & (GeometryInputCount - 1)];
+            SDL_FPoint contactPoint{0.0f, 0.0f};
+            CollisionKernels::RectRect<MovingSolidBody, StaticSolidBody>(movingRect, rect, &contactPoint);
+            checksum += contactPoint.x + movingRect.rect.y;
+        }
+        const double rectRectKernelSeconds = secondsSince(startCounter);
+
+        const char* caseName = collisionCaseName(collisionCase);
+        const double closestPointNS = closestPointSeconds * 1e9 / GeometryCalls;
+        const double collisionNS = collisionSeconds * 1e9 / GeometryCalls;
+        const double kernelNS = kernelSeconds * 1e9 / GeometryCalls;
+        const double circleCircleNS = circleCircleSeconds * 1e9 / GeometryCalls;
+        const double circleCircleKernelNS = circleCircleKernelSeconds * 1e9 / GeometryCalls;
+        const double rectRectNS = rectRectSeconds * 1e9 / GeometryCalls;
+        const double rectRectKernelNS = rectRectKernelSeconds * 1e9 / GeometryCalls;
+        SDL_Log("collision kernels, %s: GetClosestPointOnRect %.2f ns/call (%.0f%% inside), ProcessCollision %.2f ns/call, CircleRect %.2f ns/call (%.0f%% collisions%s)",
+                caseName,
+                closestPointNS, 100.0 * insideCount / GeometryCalls,
+                collisionNS, kernelNS, 100.0 * collisionCount / GeometryCalls,
+                kernelCollisionCount == collisionCount ? "" : ", COUNTS DIFFER");
+        SDL_Log("collision kernels, %s: circle-circle %.2f -> %.2f ns/call (%.0f%% collisions), rect-rect %.2f -> %.2f ns/call (%.0f%% collisions)",
+                caseName,
+                circleCircleNS, circleCircleKernelNS, 100.0 * circleCircleCount / GeometryCalls,
+                rectRectNS, rectRectKernelNS, 100.0 * rectRectCount / GeometryCalls);
+
+        addResult(a_results, "closest_point", caseName, "ns_per_call", closestPointNS);
+        addResult(a_results, "process_collision", caseName, "ns_per_call", collisionNS);
+        addResult(a_results, "process_collision", caseName, "collision_fraction", (double)collisionCount / GeometryCalls);
+        addResult(a_results, "collision_kernel", std::string("circle_rect_") + caseName, "ns_per_call", kernelNS);
+        addResult(a_results, "collision_kernel", std::string("circle_rect_") + caseName, "matches_engine", kernelCollisionCount == collisionCount ? 1.0 : 0.0);
+        addResult(a_results, "process_collision", std::string("circle_circle_") + caseName, "ns_per_call", circleCircleNS);
+        addResult(a_results, "collision_kernel", std::string("circle_circle_") + caseName, "ns_per_call", circleCircleKernelNS);
+        addResult(a_results, "process_collision", std::string("rect_rect_") + caseName, "ns_per_call", rectRectNS);
+        addResult(a_results, "collision_kernel", std::string("rect_rect_") + caseName, "ns_per_call", rectRectKernelNS);
+    }
+
+    SDL_Log("collision kernels checksum: %.0f", checksum);
+}
+
+// Seeded stress level of scoring bricks only, multi-ball bricks would make the ball count differ between
+// the sizes. The pad is widened to the whole level so every ball stays in play.
+Level
+createGeneratedLevel(const int a_brickCount)
+{
+    StressLevelOptions options;
+    options.brickCount = (Uint32)a_brickCount;
+    options.density = 1.0f;
+    options.kindWeights[(int)BrickKind::Solid] = 0.0f;
+    options.kindWeights[(int)BrickKind::MultiBall] = 0.0f;
+
+    Level level;
+    LevelFactory().CreateStressLevel({0.0f, 0.0f, (float)Constants::WINDOW_WIDTH, (float)Constants::WINDOW_HEIGHT}, options, level);
+    level.pad.geometry.rect.x = level.bounds.x;
+    level.pad.geometry.rect.w = level.bounds.w;
+
+    return level;
+}
+
+LevelController
+createLaunchedLevelController(std::shared_ptr<GeometryEngine> a_geometryEngine_sp, const Level& a_level)
+{
+    LevelController levelController(a_geometryEngine_sp, a_level);
+    levelController.SetRandomSeed(1);
+    levelController.SpawnBalls(IterateExtraBalls);
+
+    SDL_KeyboardEvent launchEvent;
+    SDL_zero(launchEvent);
+    launchEvent.type = SDL_EVENT_KEY_DOWN;
+    launchEvent.key = SDLK_SPACE;
+    launchEvent.down = true;
+    levelController.HandleKeyboardEvent(launchEvent);
+
+    return levelController;
+}
+
+// Fixed ticks of LevelController::Iterate with several balls in play. The broadphase grid should keep
+// the cost of a tick flat as the brick count grows. A level that ends is started again outside of the
+// measured time.
+void
+benchmarkLevelIterate(std::vector<BenchmarkResult>& a_results)
+{
+    std::shared_ptr<GeometryEngine> geometryEngine_sp = std::make_shared<GeometryEngine>();
+
+    for (const int brickCount : GeneratedLevelBrickCounts)
+    {
+        Uint64 startCounter = SDL_GetPerformanceCounter();
+        const Level level = createGeneratedLevel(brickCount);
+        const double generateSeconds = secondsSince(startCounter);
+
+        LevelController levelController = createLaunchedLevelController(geometryEngine_sp, level);
+        for (int tick = 0; tick < IterateWarmUpTicks && !levelController.GameOver(); tick++)
+        {
+            levelController.Iterate(IterateTickSeconds);
+        }
+
+        double iterateSeconds = 0.0;
+        Uint64 narrowphaseTests = 0;
+        int restarts = 0;
+        int ticks = 0;
+        while (ticks < IterateMeasuredTicks)
+        {
+            if (levelController.GameOver())
+            {
+                levelController = createLaunchedLevelController(geometryEngine_sp, level);
+                restarts++;
+            }
+
+            startCounter = SDL_GetPerformanceCounter();
+            while (ticks < IterateMeasuredTicks && !levelController.GameOver())
+            {
+                levelController.Iterate(IterateTickSeconds);
+                narrowphaseTests += levelController.GetNarrowphaseTestCount();
+                ticks++;
+            }
+            iterateSeconds += secondsSince(startCounter);
+        }
+
+        const std::string variant = std::to_string(brickCount) + "_bricks";
+        const double tickUS = iterateSeconds * 1e6 / IterateMeasuredTicks;
+        SDL_Log("level iterate, %d bricks: %.3f us/tick, %.2f narrowphase tests/tick, %d restarts, level generated in %.3f ms",
+                brickCount, tickUS, (double)narrowphaseTests / IterateMeasuredTicks, restarts, generateSeconds * 1000.0);
+
+        addResult(a_results, "level_iterate", variant, "us_per_tick", tickUS);
+        addResult(a_results, "level_iterate", variant, "narrowphase_tests_per_tick", (double)narrowphaseTests / IterateMeasuredTicks);
+        addResult(a_results, "level_generate", variant, "ms", generateSeconds * 1000.0);
+    }
+}
+
+// Restarting a level by constructing a new LevelController against resetting the one that already holds
+// a level. The reset copies into the existing storage and must not allocate.
+void
+benchmarkLevelRestart(std::vector<BenchmarkResult>& a_results)
+{
+    std::shared_ptr<GeometryEngine> geometryEngine_sp = std::make_shared<GeometryEngine>();
+    const Level startLevels[] = {LevelFactory().CreateLevel(Renderer().LevelBounds()), createGeneratedLevel(RestartGeneratedBrickCount)};
+
+    for (const Level& startLevel : startLevels)
+    {
+        const std::string variant = std::to_string(startLevel.bricks.Size()) + "_bricks";
+
+        Uint64 allocationsBefore = g_heapAllocationCount;
+        Uint64 startCounter = SDL_GetPerformanceCounter();
+        Uint64 freshHash = 0;
+        for (int i = 0; i < RestartCalls; i++)
+        {
+            std::shared_ptr<LevelController> levelController_sp = std::make_shared<LevelController>(geometryEngine_sp, startLevel);
+            levelController_sp->SetRandomSeed(1);
+            freshHash = levelController_sp->StateHash();
+        }
+        const double constructUS = secondsSince(startCounter) * 1e6 / RestartCalls;
+        const double constructAllocations = (double)(g_heapAllocationCount - allocationsBefore) / RestartCalls;
+
+        // Played for a while first, so the reset has to undo destroyed bricks and moved balls
+        LevelController levelController = createLaunchedLevelController(geometryEngine_sp, startLevel);
+        for (int tick = 0; tick < IterateWarmUpTicks; tick++)
+        {
+            levelController.Iterate(IterateTickSeconds);
+        }
+
+        allocationsBefore = g_heapAllocationCount;
+        startCounter = SDL_GetPerformanceCounter();
+        Uint64 resetHash = 0;
+        for (int i = 0; i < RestartCalls; i++)
+        {
+            levelController.Reset(startLevel);
+            levelController.SetRandomSeed(1);
+            resetHash = levelController.StateHash();
+        }
+        const double resetUS = secondsSince(startCounter) * 1e6 / RestartCalls;
+        const double resetAllocations = (double)(g_heapAllocationCount - allocationsBefore) / RestartCalls;
+
+        SDL_Log("level restart, %zu bricks: new controller %.2f us and %.1f heap allocations, reset %.2f us and %.1f heap allocations, state %s",
+                startLevel.bricks.Size(), constructUS, constructAllocations, resetUS, resetAllocations, freshHash == resetHash ? "matches" : "DIFFERS");
+
+        addResult(a_results, "level_restart", variant + "_new_controller", "us", constructUS);
+        addResult(a_results, "level_restart", variant + "_new_controller", "heap_allocations", constructAllocations);
+        addResult(a_results, "level_restart", variant + "_reset", "us", resetUS);
+        addResult(a_results, "level_restart", variant + "_reset", "heap_allocations", resetAllocations);
+    }
+}
+
+// Snapshot and restore of the simulation state, and recording every tick into a rewind ring. The level
+// is played for a while after the snapshot, so the restore has to bring bricks back to life, and then
+// the same ticks are played again from the restored state, which has to repeat them exactly.
+void
+benchmarkSnapshots(std::vector<BenchmarkResult>& a_results)
+{
+    std::shared_ptr<GeometryEngine> geometryEngine_sp = std::make_shared<GeometryEngine>();
+    const Level levels[] = {LevelFactory().CreateLevel(Renderer().LevelBounds()), createGeneratedLevel(SnapshotGeneratedBrickCount)};
+    LevelSnapshot snapshot;
+    RewindBuffer rewindBuffer(Constants::RewindHistoryTicks);
+    std::vector<Uint64> stateHashes(SnapshotReplayTicks);
+
+    for (const Level& level : levels)
+    {
+        const std::string variant = std::to_string(level.bricks.Size()) + "_bricks";
+        LevelController levelController = createLaunchedLevelController(geometryEngine_sp, level);
+
+        Uint64 allocationsBefore = g_heapAllocationCount;
+        Uint64 startCounter = SDL_GetPerformanceCounter();
+        bool snapshotTaken = true;
+        for (int i = 0; i < SnapshotCalls; i++)
+        {
+            snapshotTaken = levelController.Snapshot(snapshot) && snapshotTaken;
+        }
+        const double snapshotNS = secondsSince(startCounter) * 1e9 / SnapshotCalls;
+        Uint64 allocations = g_heapAllocationCount - allocationsBefore;
+
+        for (Uint64& stateHash : stateHashes)
+        {
+            levelController.Iterate(IterateTickSeconds);
+            stateHash = levelController.StateHash();
+        }
+        const Uint32 playedScore = levelController.GetLevel().score;
+
+        allocationsBefore = g_heapAllocationCount;
+        startCounter = SDL_GetPerformanceCounter();
+        for (int i = 0; i < SnapshotCalls; i++)
+        {
+            levelController.Restore(snapshot);
+        }
+        const double restoreNS = secondsSince(startCounter) * 1e9 / SnapshotCalls;
+        allocations += g_heapAllocationCount - allocationsBefore;
+
+        // A restore after play brings the destroyed bricks back, which also updates the brick grid
+        levelController.Iterate(IterateTickSeconds);
+        startCounter = SDL_GetPerformanceCounter();
+        levelController.Restore(snapshot);
+        const double restoreAfterPlayNS = secondsSince(startCounter) * 1e9;
+
+        bool replayMatched = true;
+        for (const Uint64 stateHash : stateHashes)
+        {
+            levelController.Iterate(IterateTickSeconds);
+            replayMatched = replayMatched && levelController.StateHash() == stateHash;
+        }
+
+        rewindBuffer.Clear();
+        allocationsBefore = g_heapAllocationCount;
+        startCounter = SDL_GetPerformanceCounter();
+        for (int i = 0; i < SnapshotCalls; i++)
+        {
+            rewindBuffer.Record(levelController);
+        }
+        const double recordNS = secondsSince(startCounter) * 1e9 / SnapshotCalls;
+        allocations += g_heapAllocationCount - allocationsBefore;
+
+        SDL_Log("snapshots, %s: snapshot %.1f ns, restore %.1f ns (%.1f ns after %d ticks, score %u), rewind record %.1f ns, "
+                "%zu bytes, replay from the snapshot %s, %llu heap allocations%s",
+                variant.c_str(), snapshotNS, restoreNS, restoreAfterPlayNS, SnapshotReplayTicks, playedScore, recordNS,
+                sizeof(LevelSnapshot), replayMatched ? "matches" : "DIFFERS", (unsigned long long)allocations, snapshotTaken ? "" : ", snapshot FAILED");
+
+        addResult(a_results, "snapshot", variant, "snapshot_ns", snapshotNS);
+        addResult(a_results, "snapshot", variant, "restore_ns", restoreNS);
+        addResult(a_results, "snapshot", variant, "restore_after_play_ns", restoreAfterPlayNS);
+        addResult(a_results, "snapshot", variant, "rewind_record_ns", recordNS);
+        addResult(a_results, "snapshot", variant, "replay_matches", replayMatched && snapshotTaken ? 1.0 : 0.0);
+        addResult(a_results, "snapshot", variant, "heap_allocations", (double)allocations);
+    }
+}
+
+// Generating stress levels on the calling thread and on every core. The runs after the first reuse the
+// storage of the level, so they show the generation itself without the allocations.
+void
+benchmarkStressLevelGeneration(std::vector<BenchmarkResult>& a_results)
+{
+    LevelFactory levelFactory;
+    const SDL_FRect levelBounds{0.0f, 0.0f, (float)Constants::WINDOW_WIDTH, (float)Constants::WINDOW_HEIGHT};
+
+    for (const Uint32 brickCount : StressLevelBrickCounts)
+    {
+        StressLevelOptions options;
+        options.brickCount = brickCount;
+
+        Level levels[2];
+        const char* const variantNames[2] = {"single_thread", "all_cores"};
+        for (int variant = 0; variant < 2; variant++)
+        {
+            options.threadCount = variant == 0 ? 1 : 0;
+
+            double firstMS = 0.0;
+            double bestMS = 0.0;
+            for (int run = 0; run < StressLevelRuns; run++)
+            {
+                const Uint64 startCounter = SDL_GetPerformanceCounter();
+                levelFactory.CreateStressLevel(levelBounds, options, levels[variant]);
+                const double runMS = secondsSince(startCounter) * 1000.0;
+
+                firstMS = run == 0 ? runMS : firstMS;
+                bestMS = run == 0 ? runMS : SDL_min(bestMS, runMS);
+            }
+
+            const std::string variantName = std::to_string(brickCount) + "_bricks_" + variantNames[variant];
+            SDL_Log("stress level, %u bricks, %s: first %.3f ms, best reusing the level %.3f ms, %.1f M bricks/s",
+                    brickCount, variantNames[variant], firstMS, bestMS, brickCount / (bestMS * 1000.0));
+
+            addResult(a_results, "stress_level_generate", variantName, "first_ms", firstMS);
+            addResult(a_results, "stress_level_generate", variantName, "best_ms", bestMS);
+        }
+
+        // The rows are generated independently, so the thread count must not change the level
+        const BrickStore& single = levels[0].bricks;
+        const BrickStore& parallel = levels[1].bricks;
+        const bool identical = single.x == parallel.x && single.y == parallel.y && single.kind == parallel.kind;
+        SDL_Log("stress level, %u bricks: single thread and all cores levels %s", brickCount, identical ? "match" : "DIFFER");
+        addResult(a_results, "stress_level_generate", std::to_string(brickCount) + "_bricks", "levels_match", identical ? 1.0 : 0.0);
+    }
+}
+
+// Latency distribution of building the standard level the game starts with
+void
+benchmarkCreateLevel(std::vector<BenchmarkResult>& a_results)
+{
+    LevelFactory levelFactory;
+    const SDL_FRect levelBounds = Renderer().LevelBounds();
+    std::vector<double> latenciesUS(CreateLevelCalls);
+    size_t brickCount = 0;
+
+    const Uint64 allocationsBefore = g_heapAllocationCount;
+    for (double& latencyUS : latenciesUS)
+    {
+        const Uint64 startCounter = SDL_GetPerformanceCounter();
+        const Level level = levelFactory.CreateLevel(levelBounds);
+        latencyUS = secondsSince(startCounter) * 1e6;
+        brickCount += level.bricks.aliveCount;
+    }
+    const double allocationsPerLevel = (double)(g_heapAllocationCount - allocationsBefore) / CreateLevelCalls;
+
+    double totalUS = 0.0;
+    for (const double latencyUS : latenciesUS)
+    {
+        totalUS += latencyUS;
+    }
+    std::sort(latenciesUS.begin(), latenciesUS.end());
+    const double meanUS = totalUS / CreateLevelCalls;
+    const double p50US = latenciesUS[CreateLevelCalls / 2];
+    const double p99US = latenciesUS[CreateLevelCalls * 99 / 100];
+    const double maxUS = latenciesUS.back();
+
+    SDL_Log("create level, %zu bricks: mean %.2f us, p50 %.2f us, p99 %.2f us, max %.2f us, %.1f heap allocations/level",
+            brickCount / CreateLevelCalls, meanUS, p50US, p99US, maxUS, allocationsPerLevel);
+
+    addResult(a_results, "create_level", "standard", "mean_us", meanUS);
+    addResult(a_results, "create_level", "standard", "p50_us", p50US);
+    addResult(a_results, "create_level", "standard", "p99_us", p99US);
+    addResult(a_results, "create_level", "standard", "max_us", maxUS);
+    addResult(a_results, "create_level", "standard", "heap_allocations", allocationsPerLevel);
+}
+
+// Writes a square level file with a_size rows of a_size bricks. Large sizes get narrower bricks, so that
+// every row fits a_levelWidth and the level loads.
+bool
+writeLevelFile(const char* a_path, const int a_size, const float a_levelWidth)
+{
+    SDL_IOStream* stream_p = SDL_IOFromFile(a_path, "w");
+    if (!stream_p)
+    {
+        SDL_Log("Couldn't open %s: %s", a_path, SDL_GetError());
+        return false;
+    }
+
+    const char cellKinds[] = "LNHM";
+    std::string row(a_size, 'L');
+    const float spacing = a_size > 10 ? 1.0f : 15.0f;
+    const float brickWidth = SDL_min(70.0f, SDL_floorf((a_levelWidth - spacing * (a_size - 1)) / a_size));
+    const float brickHeight = SDL_min(35.0f, brickWidth / 2.0f);
+    SDL_IOprintf(stream_p, "# Generated by the benchmark\nbrick %g %g\nspacing %g\nmargin 80\n", brickWidth, brickHeight, spacing);
+    for (int line = 0; line < a_size; line++)
+    {
+        for (int cell = 0; cell < a_size; cell++)
+        {
+            row[cell] = cellKinds[(line + cell) % 4];
+        }
+        SDL_IOprintf(stream_p, "row %s\n", row.c_str());
+    }
+
+    return SDL_CloseIO(stream_p);
+}
+
+// Loading a level file, once cold with a new factory for every load (map, parse and build) and once
+// from the parsed layout cache into the same Level, the way a restart reloads it. Fails when a generated
+// level doesn't load, the measurements of that size would be missing otherwise.
+bool
+benchmarkLevelLoading(std::vector<BenchmarkResult>& a_results)
+{
+    const SDL_FRect levelBounds = Renderer().LevelBounds();
+    bool passed = true;
+
+    for (const int size : LevelFileSizes)
+    {
+        if (!writeLevelFile(BenchmarkLevelPath, size, levelBounds.w))
+        {
+            return false;
+        }
+
+        bool loaded = true;
+        Uint64 startCounter = SDL_GetPerformanceCounter();
+        for (int call = 0; call < LevelLoadCalls && loaded; call++)
+        {
+            Level level;
+            loaded = LevelFactory().LoadLevel(BenchmarkLevelPath, levelBounds, level);
+        }
+        const double coldSeconds = secondsSince(startCounter);
+
+        LevelFactory levelFactory;
+        Level level;
+        loaded = loaded && levelFactory.LoadLevel(BenchmarkLevelPath, levelBounds, level);
+
+        const Uint64 allocationsBefore = g_heapAllocationCount;
+        startCounter = SDL_GetPerformanceCounter();
+        for (int call = 0; call < LevelLoadCalls && loaded; call++)
+        {
+            loaded = levelFactory.LoadLevel(BenchmarkLevelPath, levelBounds, level);
+        }
+        const double cachedSeconds = secondsSince(startCounter);
+        const double cachedAllocations = (double)(g_heapAllocationCount - allocationsBefore) / LevelLoadCalls;
+
+        if (!loaded)
+        {
+            SDL_Log("level loading: couldn't load the generated level of %d bricks - FAILED", size * size);
+            passed = false;
+            break;
+        }
+
+        const std::string variant = std::to_string(size * size) + "_bricks";
+        const double coldUS = coldSeconds * 1e6 / LevelLoadCalls;
+        const double cachedUS = cachedSeconds * 1e6 / LevelLoadCalls;
+        SDL_Log("level loading, %d bricks: cold %.2f us, cached %.2f us with %.1f heap allocations/load",
+                size * size, coldUS, cachedUS, cachedAllocations);
+
+        addResult(a_results, "load_level", variant, "cold_us", coldUS);
+        addResult(a_results, "load_level", variant, "cached_us", cachedUS);
+        addResult(a_results, "load_level", variant, "cached_heap_allocations", cachedAllocations);
+    }
+
+    SDL_RemovePath(BenchmarkLevelPath);
+    return passed;
+}
+
+}
+
+int
+main(int argc, char *argv[])
+{
+    const char* csvPath_p = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (SDL_strcmp(argv[i], "--csv") == 0 && i + 1 < argc)
+        {
+            csvPath_p = argv[++i];
+        }
+        else
+        {
+            SDL_Log("Usage: %s [--csv FILE]", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<BenchmarkResult> results;
+    benchmarkBrickRemoval(results);
+    benchmarkCircleMeshes(results);
+    benchmarkCollisionKernels(results);
+    benchmarkLevelIterate(results);
+    benchmarkCreateLevel(results);
+    benchmarkLevelRestart(results);
+    benchmarkSnapshots(results);
+    benchmarkStressLevelGeneration(results);
+    const bool levelLoadingPassed = benchmarkLevelLoading(results);
+    const bool allocationCheckPassed = benchmarkLevelFrameAllocations(results);
+
+    if (csvPath_p && !writeResultsCsv(csvPath_p, results))
+    {
+        return 1;
+    }
+
+    return levelLoadingPassed && allocationCheckPassed ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include "BrickGrid.hpp"
+
+#include "gameobjects/BrickStore.hpp"
+
+#include <algorithm>
+
+void
+BrickGrid::Build(const SDL_FRect& a_bounds, const float a_cellSize, const BrickStore& a_bricks)
+{
+    m_bounds = a_bounds;
+    m_cellSize = a_cellSize;
+    m_columns = SDL_max(1, (int)SDL_ceilf(a_bounds.w / a_cellSize));
+    m_rows = SDL_max(1, (int)SDL_ceilf(a_bounds.h / a_cellSize));
+
+    const size_t cellCount = (size_t)m_columns * (size_t)m_rows;
+    m_cellStart.assign(cellCount + 1, 0);
+    m_cellCount.assign(cellCount, 0);
+
+    // First pass counts the entries of each cell, second pass fills them in
+    int minColumn, minRow, maxColumn, maxRow;
+    for (size_t brickIndex = 0; brickIndex < a_bricks.Size(); brickIndex++)
+    {
+        if (!a_bricks.IsAlive(brickIndex))
+        {
+            continue;
+        }
+
+        getCellRange(a_bricks.Rect(brickIndex), minColumn, minRow, maxColumn, maxRow);
+        for (int row = minRow; row <= maxRow; row++)
+        {
+            for (int column = minColumn; column <= maxColumn; column++)
+            {
+                m_cellCount[row * m_columns + column]++;
+            }
+        }
+    }
+
+    for (size_t cell = 0; cell < cellCount; cell++)
+    {
+        m_cellStart[cell + 1] = m_cellStart[cell] + m_cellCount[cell];
+        m_cellCount[cell] = 0;
+    }
+
+    m_brickIndices.resize(m_cellStart[cellCount]);
+    for (Uint32 brickIndex = 0; brickIndex < a_bricks.Size(); brickIndex++)
+    {
+        if (!a_bricks.IsAlive(brickIndex))
+        {
+            continue;
+        }
+
+        getCellRange(a_bricks.Rect(brickIndex), minColumn, minRow, maxColumn, maxRow);
+        for (int row = minRow; row <= maxRow; row++)
+        {
+            for (int column = minColumn; column <= maxColumn; column++)
+            {
+                const int cell = row * m_columns + column;
+                m_brickIndices[m_cellStart[cell] + m_cellCount[cell]++] = brickIndex;
+            }
+        }
+    }
+}
+
+void
+BrickGrid::Remove(const Uint32 a_brickIndex, const SDL_FRect& a_brickRect)
+{
+    int minColumn, minRow, maxColumn, maxRow;
+    getCellRange(a_brickRect, minColumn, minRow, maxColumn, maxRow);
+    for (int row = minRow; row <= maxRow; row++)
+    {
+        for (int column = minColumn; column <= maxColumn; column++)
+        {
+            const int cell = row * m_columns + column;
+            Uint32* cellBegin = m_brickIndices.data() + m_cellStart[cell];
+            Uint32* cellEnd = cellBegin + m_cellCount[cell];
+
+            Uint32* entry = std::find(cellBegin, cellEnd, a_brickIndex);
+            if (entry != cellEnd)
+            {
+                *entry = *(cellEnd - 1);
+                m_cellCount[cell]--;
+            }
+        }
+    }
+}
+
+void
+BrickGrid::Insert(const Uint32 a_brickIndex, const SDL_FRect& a_brickRect)
+{
+    int minColumn, minRow, maxColumn, maxRow;
+    getCellRange(a_brickRect, minColumn, minRow, maxColumn, maxRow);
+    for (int row = minRow; row <= maxRow; row++)
+    {
+        for (int column = minColumn; column <= maxColumn; column++)
+        {
+            // Cell ranges never grow, a full cell means the brick is in it already or was dead at build time
+            const int cell = row * m_columns + column;
+            if (m_cellStart[cell] + m_cellCount[cell] < m_cellStart[cell + 1])
+            {
+                m_brickIndices[m_cellStart[cell] + m_cellCount[cell]++] = a_brickIndex;
+            }
+        }
+    }
+}
+
+void
+BrickGrid::Query(const SDL_FRect& a_area, std::vector<Uint32>& a_brickIndices) const
+{
+    a_brickIndices.clear();
+    if (m_cellCount.empty())
+    {
+        return;
+    }
+
+    int minColumn, minRow, maxColumn, maxRow;
+    getCellRange(a_area, minColumn, minRow, maxColumn, maxRow);
+    for (int row = minRow; row <= maxRow; row++)
+    {
+        for (int column = minColumn; column <= maxColumn; column++)
+        {
+            const int cell = row * m_columns + column;
+            const Uint32* cellBegin = m_brickIndices.data() + m_cellStart[cell];
+            a_brickIndices.insert(a_brickIndices.end(), cellBegin, cellBegin + m_cellCount[cell]);
+        }
+    }
+
+    // Bricks spanning several cells are reported once, in storage order so collisions resolve as before
+    std::sort(a_brickIndices.begin(), a_brickIndices.end());
+    a_brickIndices.erase(std::unique(a_brickIndices.begin(), a_brickIndices.end()), a_brickIndices.end());
+}
+
+void
+BrickGrid::getCellRange(const SDL_FRect& a_area, int& a_minColumn, int& a_minRow, int& a_maxColumn, int& a_maxRow) const
+{
+    // Anything outside of the bounds is assigned to the border cells
+    a_minColumn = SDL_clamp((int)SDL_floorf((a_area.x - m_bounds.x) / m_cellSize), 0, m_columns - 1);
+    a_minRow = SDL_clamp((int)SDL_floorf((a_area.y - m_bounds.y) / m_cellSize), 0, m_rows - 1);
+    a_maxColumn = SDL_clamp((int)SDL_floorf((a_area.x + a_area.w - m_bounds.x) / m_cellSize), 0, m_columns - 1);
+    a_maxRow = SDL_clamp((int)SDL_floorf((a_area.y + a_area.h - m_bounds.y) / m_cellSize), 0, m_rows - 1);
+}
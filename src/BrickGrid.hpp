@@ -0,0 +1,36 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include <vector>
+
+struct BrickStore;
+
+// Uniform grid over the level bounds that maps cells to the indices of the bricks overlapping them.
+// Cell contents are stored in one flat array (cell ranges are fixed at build time, bricks are only
+// ever removed) so the grid copies cheaply together with the level. Dead bricks are removed from
+// their cells, so queries only ever return live bricks.
+class BrickGrid
+{
+public:
+    void Build(const SDL_FRect& a_bounds, const float a_cellSize, const BrickStore& a_bricks);
+    void Remove(const Uint32 a_brickIndex, const SDL_FRect& a_brickRect);
+    // Puts a removed brick back into its cells, only bricks that were alive when the grid was built fit
+    void Insert(const Uint32 a_brickIndex, const SDL_FRect& a_brickRect);
+
+    // Collects indices of bricks in the cells overlapped by a_area, sorted ascending and without duplicates
+    void Query(const SDL_FRect& a_area, std::vector<Uint32>& a_brickIndices) const;
+
+private:
+    void getCellRange(const SDL_FRect& a_area, int& a_minColumn, int& a_minRow, int& a_maxColumn, int& a_maxRow) const;
+
+private:
+    SDL_FRect m_bounds{0.0f, 0.0f, 0.0f, 0.0f};
+    float m_cellSize = 1.0f;
+    int m_columns = 0;
+    int m_rows = 0;
+
+    std::vector<Uint32> m_cellStart;
+    std::vector<Uint32> m_cellCount;
+    std::vector<Uint32> m_brickIndices;
+};
@@ -0,0 +1,123 @@
+#include "CircleMeshCache.hpp"
+
+#include "Constants.hpp"
+
+namespace
+{
+
+// Largest distance in pixels between the true circle and its polygon, decides the level of detail
+const float MaxCircleErrorPixels = 0.25f;
+
+}
+
+CircleMeshCache::CircleMeshCache()
+    : m_pixelsPerUnit(1.0f)
+{
+    // Every level doubles the segment count of the previous one
+    for (int segments = Constants::MinCircleSegments; segments <= Constants::MaxCircleSegments; segments *= 2)
+    {
+        Lod lod;
+        lod.segments = segments;
+        lod.firstPoint = m_unitCircle.size();
+        // A polygon with n segments is off by at most r * (1 - cos(pi / n))
+        lod.maxPixelRadius = MaxCircleErrorPixels / (1.0f - SDL_cosf(SDL_PI_F / (float)segments));
+        m_lods.push_back(lod);
+
+        for (int i = 0; i < segments; i++)
+        {
+            const float theta = (float)i / (float)segments * 2.0f * SDL_PI_F;
+            m_unitCircle.push_back({SDL_cosf(theta), SDL_sinf(theta)});
+        }
+    }
+}
+
+void
+CircleMeshCache::Clear(const float a_pixelsPerUnit)
+{
+    m_pixelsPerUnit = a_pixelsPerUnit;
+    m_vertices.clear();
+    m_indices.clear();
+}
+
+void
+CircleMeshCache::Add(const SDL_FPoint& a_center, const float a_radius, const SDL_FColor& a_color)
+{
+    const Lod& lod = lodForRadius(a_radius * m_pixelsPerUnit);
+    const SDL_FPoint noTexture{0.0f, 0.0f};
+
+    // Indexed fan: the center followed by the rim, one triangle per segment
+    const size_t center = m_vertices.size();
+    m_vertices.resize(center + 1 + lod.segments);
+    SDL_Vertex* vertices_p = &m_vertices[center];
+    vertices_p[0] = {a_center, a_color, noTexture};
+
+    const SDL_FPoint* unitPoints_p = &m_unitCircle[lod.firstPoint];
+    for (int i = 0; i < lod.segments; i++)
+    {
+        vertices_p[1 + i].position = {a_center.x + a_radius * unitPoints_p[i].x, a_center.y + a_radius * unitPoints_p[i].y};
+        vertices_p[1 + i].color = a_color;
+        vertices_p[1 + i].tex_coord = noTexture;
+    }
+
+    const size_t firstIndex = m_indices.size();
+    m_indices.resize(firstIndex + lod.segments * 3);
+    int* indices_p = &m_indices[firstIndex];
+    for (int i = 0; i < lod.segments; i++)
+    {
+        indices_p[i * 3] = (int)center;
+        indices_p[i * 3 + 1] = (int)center + 1 + i;
+        indices_p[i * 3 + 2] = (int)center + 2 + i;
+    }
+    // The last triangle closes the fan back at the first rim vertex
+    indices_p[lod.segments * 3 - 1] = (int)center + 1;
+}
+
+bool
+CircleMeshCache::Empty() const
+{
+    return m_vertices.empty();
+}
+
+int
+CircleMeshCache::SegmentsForRadius(const float a_pixelRadius) const
+{
+    return lodForRadius(a_pixelRadius).segments;
+}
+
+const SDL_Vertex*
+CircleMeshCache::Vertices() const
+{
+    return m_vertices.data();
+}
+
+int
+CircleMeshCache::VertexCount() const
+{
+    return (int)m_vertices.size();
+}
+
+const int*
+CircleMeshCache::Indices() const
+{
+    return m_indices.data();
+}
+
+int
+CircleMeshCache::IndexCount() const
+{
+    return (int)m_indices.size();
+}
+
+const CircleMeshCache::Lod&
+CircleMeshCache::lodForRadius(const float a_pixelRadius) const
+{
+    for (const Lod& lod : m_lods)
+    {
+        if (a_pixelRadius <= lod.maxPixelRadius)
+        {
+            return lod;
+        }
+    }
+
+    return m_lods.back();
+}
\ No newline at end of file
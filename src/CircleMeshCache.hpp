@@ -0,0 +1,48 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include <vector>
+
+// Unit-circle tables for a few levels of detail, computed once, and a batch that turns circles into
+// indexed triangle fans using them. The level of detail is picked from the on-screen radius so small
+// circles get fewer segments. All circles added since the last Clear are drawn with one geometry call.
+class CircleMeshCache
+{
+public:
+    CircleMeshCache();
+    virtual ~CircleMeshCache() = default;
+
+    // Drops the queued circles, keeps the buffers. a_pixelsPerUnit converts radii to on-screen pixels.
+    void Clear(const float a_pixelsPerUnit);
+    void Add(const SDL_FPoint& a_center, const float a_radius, const SDL_FColor& a_color);
+    bool Empty() const;
+
+    // Segment count used for a circle of the given radius in on-screen pixels
+    int SegmentsForRadius(const float a_pixelRadius) const;
+
+    const SDL_Vertex* Vertices() const;
+    int VertexCount() const;
+    const int* Indices() const;
+    int IndexCount() const;
+
+private:
+    struct Lod
+    {
+        int segments = 0;
+        // Index of the first rim point in m_unitCircle
+        size_t firstPoint = 0;
+        // Largest on-screen radius drawn at this level of detail
+        float maxPixelRadius = 0.0f;
+    };
+
+    const Lod& lodForRadius(const float a_pixelRadius) const;
+
+private:
+    std::vector<Lod> m_lods;
+    std::vector<SDL_FPoint> m_unitCircle;
+    float m_pixelsPerUnit;
+
+    std::vector<SDL_Vertex> m_vertices;
+    std::vector<int> m_indices;
+};
\ No newline at end of file
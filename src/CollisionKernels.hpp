@@ -0,0 +1,412 @@
+#pragma once
+
+#include "gameobjects/ObjectGeometry.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <limits>
+
+// Compile time description of a collision participant. Two solid participants are pushed apart and
+// bounce off each other, anything else only reports the contact. A moving participant must have a
+// velocity, a static one is never moved or given one.
+template <bool TSolid, bool TMoving>
+struct CollisionBody
+{
+    static constexpr bool Solid = TSolid;
+    static constexpr bool Moving = TMoving;
+};
+
+typedef CollisionBody<true, true> MovingSolidBody;
+typedef CollisionBody<true, false> StaticSolidBody;
+typedef CollisionBody<false, true> MovingSensorBody;
+typedef CollisionBody<false, false> StaticSensorBody;
+
+// Collision tests and responses for every pair of shapes. The response is picked at compile time from
+// the bodies of the pair instead of from GeometryProperties at run time, and the kernels are inline free
+// functions, so loops that know what they collide call them directly without any dispatch.
+// GeometryEngine checks the properties at run time and forwards to the matching kernel.
+namespace CollisionKernels
+{
+    // Point of the rect closest to a_center. A center inside the rect gives the closest point on the rect
+    // edges instead and sets a_isInsideRect.
+    inline SDL_FPoint
+    ClosestPointOnRect(const SDL_FPoint& a_center, const SDL_FRect& a_rect, bool& a_isInsideRect)
+    {
+        if (SDL_PointInRectFloat(&a_center, &a_rect))
+        {
+            a_isInsideRect = true;
+            const SDL_FPoint closestPointsOnEdges[4] = {
+                {a_rect.x, a_center.y},             // Left
+                {a_rect.x + a_rect.w, a_center.y},  // Right
+                {a_center.x, a_rect.y},             // Top
+                {a_center.x, a_rect.y + a_rect.h}  // Bottom
+            };
+
+            int closestPointIndex = 0;
+            float closestDistanceSquared = 0.0f;
+            for (int i = 0; i < 4; i++)
+            {
+                const SDL_FPoint difference{
+                    a_center.x - closestPointsOnEdges[i].x,
+                    a_center.y - closestPointsOnEdges[i].y
+                };
+                const float currentDistanceSquared = (difference.x * difference.x) + (difference.y * difference.y);
+
+                if (i == 0 || currentDistanceSquared < closestDistanceSquared)
+                {
+                    closestPointIndex = i;
+                    closestDistanceSquared = currentDistanceSquared;
+                }
+            }
+
+            return closestPointsOnEdges[closestPointIndex];
+        }
+
+        a_isInsideRect = false;
+        return {
+            SDL_clamp(a_center.x, a_rect.x, a_rect.x + a_rect.w),
+            SDL_clamp(a_center.y, a_rect.y, a_rect.y + a_rect.h)
+        };
+    }
+
+    // Reflects a moving circle off the rect. The rect is never moved, a moving rect like the pad only
+    // counts by where it is now.
+    template <typename TCircle, typename TRect>
+    inline bool
+    CircleRect(CircleGeometry& a_circle, const SDL_FRect& a_rect, SDL_FPoint* a_contactPoint_p)
+    {
+        bool centerIsInsideRect = false;
+        const SDL_FPoint closestPoint = ClosestPointOnRect(a_circle.center, a_rect, centerIsInsideRect);
+        SDL_FPoint distanceToClosestPoint{
+            a_circle.center.x - closestPoint.x,
+            a_circle.center.y - closestPoint.y
+        };
+
+        // Avoding more calculations for obvious non-collisions
+        if (!centerIsInsideRect && (SDL_abs(distanceToClosestPoint.x) + SDL_abs(distanceToClosestPoint.y)) > a_circle.radius)
+        {
+            return false;
+        }
+
+        const float distanceSquared = distanceToClosestPoint.x * distanceToClosestPoint.x +
+                                      distanceToClosestPoint.y * distanceToClosestPoint.y;
+        if (!centerIsInsideRect && !(distanceSquared < (a_circle.radius * a_circle.radius)))
+        {
+            return false;
+        }
+
+        if (a_contactPoint_p)
+        {
+            *a_contactPoint_p = closestPoint;
+        }
+
+        if constexpr (!TCircle::Solid || !TRect::Solid || !TCircle::Moving)
+        {
+            return true;
+        }
+        else
+        {
+            if (centerIsInsideRect)
+            {
+                // Push circle out to the edge of the rectangle, whichever direction is shortest
+                if (SDL_abs(distanceToClosestPoint.x) > SDL_abs(distanceToClosestPoint.y))
+                {
+                    a_circle.center.x = closestPoint.x + (distanceToClosestPoint.x > 0 ? -a_circle.radius : a_circle.radius);
+                    a_circle.center.y = closestPoint.y;
+                }
+                else
+                {
+                    a_circle.center.x = closestPoint.x;
+                    a_circle.center.y = closestPoint.y + (distanceToClosestPoint.y > 0 ? -a_circle.radius : a_circle.radius);
+                }
+
+                distanceToClosestPoint.x = a_circle.center.x - closestPoint.x;
+                distanceToClosestPoint.y = a_circle.center.y - closestPoint.y;
+            }
+
+            const float normalLength = SDL_sqrtf(distanceSquared);
+            const SDL_FPoint normal{
+                distanceToClosestPoint.x / normalLength,
+                distanceToClosestPoint.y / normalLength
+            };
+
+            SDL_FPoint& velocity = *a_circle.properties.velocity;
+            const float velocityDotNormal = velocity.x * normal.x + velocity.y * normal.y;
+
+            if (velocityDotNormal > 0)
+            {
+                // Moving away from the surface, no collision
+                return false;
+            }
+
+            a_circle.center.x = closestPoint.x + normal.x * a_circle.radius;
+            a_circle.center.y = closestPoint.y + normal.y * a_circle.radius;
+            velocity.x -= 2.0f * velocityDotNormal * normal.x;
+            velocity.y -= 2.0f * velocityDotNormal * normal.y;
+
+            if (SDL_isnan(velocity.x) || SDL_isnan(velocity.y) || SDL_isnan(a_circle.center.x) || SDL_isnan(a_circle.center.y))
+            {
+                velocity.x = 0.0f;
+                velocity.y = 0.0f;
+            }
+
+            return true;
+        }
+    }
+
+    // Separates two overlapping circles and exchanges their velocity along the normal as equal masses.
+    // A static circle acts as a wall, it is neither pushed nor given a velocity.
+    template <typename TCircle, typename TOtherCircle>
+    inline bool
+    CircleCircle(CircleGeometry& a_circle, CircleGeometry& a_otherCircle, SDL_FPoint* a_contactPoint_p)
+    {
+        const SDL_FPoint distance{
+            a_otherCircle.center.x - a_circle.center.x,
+            a_otherCircle.center.y - a_circle.center.y
+        };
+        const float radiusSum = a_circle.radius + a_otherCircle.radius;
+
+        // Avoding more calculations for obvious non-collisions
+        if (SDL_abs(distance.x) > radiusSum || SDL_abs(distance.y) > radiusSum)
+        {
+            return false;
+        }
+
+        const float distanceSquared = distance.x * distance.x + distance.y * distance.y;
+        if (distanceSquared >= radiusSum * radiusSum)
+        {
+            return false;
+        }
+
+        // Normal points from the first circle to the other one, concentric circles get pushed apart sideways
+        const float distanceLength = SDL_sqrtf(distanceSquared);
+        const SDL_FPoint normal = distanceLength > 0.0f ? SDL_FPoint{distance.x / distanceLength, distance.y / distanceLength} : SDL_FPoint{1.0f, 0.0f};
+
+        if (a_contactPoint_p)
+        {
+            a_contactPoint_p->x = a_circle.center.x + normal.x * a_circle.radius;
+            a_contactPoint_p->y = a_circle.center.y + normal.y * a_circle.radius;
+        }
+
+        if constexpr (!TCircle::Solid || !TOtherCircle::Solid || (!TCircle::Moving && !TOtherCircle::Moving))
+        {
+            return true;
+        }
+        else
+        {
+            const SDL_FPoint velocity = TCircle::Moving ? *a_circle.properties.velocity : SDL_FPoint{0.0f, 0.0f};
+            const SDL_FPoint otherVelocity = TOtherCircle::Moving ? *a_otherCircle.properties.velocity : SDL_FPoint{0.0f, 0.0f};
+            const float approachSpeed = (velocity.x - otherVelocity.x) * normal.x + (velocity.y - otherVelocity.y) * normal.y;
+
+            if (approachSpeed <= 0)
+            {
+                // Moving away from each other, no collision
+                return false;
+            }
+
+            // Separate the circles, a static circle does not get pushed
+            const float penetration = radiusSum - distanceLength;
+            constexpr float circleShare = !TOtherCircle::Moving ? 1.0f : (!TCircle::Moving ? 0.0f : 0.5f);
+            if constexpr (TCircle::Moving)
+            {
+                a_circle.center.x -= normal.x * penetration * circleShare;
+                a_circle.center.y -= normal.y * penetration * circleShare;
+            }
+            if constexpr (TOtherCircle::Moving)
+            {
+                a_otherCircle.center.x += normal.x * penetration * (1.0f - circleShare);
+                a_otherCircle.center.y += normal.y * penetration * (1.0f - circleShare);
+            }
+
+            // Equal masses exchange the velocity component along the normal, a static circle acts as a wall
+            if constexpr (TCircle::Moving && TOtherCircle::Moving)
+            {
+                a_circle.properties.velocity->x -= approachSpeed * normal.x;
+                a_circle.properties.velocity->y -= approachSpeed * normal.y;
+                a_otherCircle.properties.velocity->x += approachSpeed * normal.x;
+                a_otherCircle.properties.velocity->y += approachSpeed * normal.y;
+            }
+            else if constexpr (TCircle::Moving)
+            {
+                a_circle.properties.velocity->x -= 2.0f * approachSpeed * normal.x;
+                a_circle.properties.velocity->y -= 2.0f * approachSpeed * normal.y;
+            }
+            else
+            {
+                a_otherCircle.properties.velocity->x += 2.0f * approachSpeed * normal.x;
+                a_otherCircle.properties.velocity->y += 2.0f * approachSpeed * normal.y;
+            }
+
+            return true;
+        }
+    }
+
+    // Separates two overlapping rects along the axis of the shallower overlap, split between the moving
+    // ones, and stops the velocity of a moving rect along that axis when it points into the other rect.
+    // The contact point is the center of the overlap.
+    template <typename TRect, typename TOtherRect>
+    inline bool
+    RectRect(RectGeometry& a_rect, RectGeometry& a_otherRect, SDL_FPoint* a_contactPoint_p)
+    {
+        SDL_FRect& rect = a_rect.rect;
+        SDL_FRect& otherRect = a_otherRect.rect;
+        const float overlapLeft = SDL_max(rect.x, otherRect.x);
+        const float overlapRight = SDL_min(rect.x + rect.w, otherRect.x + otherRect.w);
+        const float overlapTop = SDL_max(rect.y, otherRect.y);
+        const float overlapBottom = SDL_min(rect.y + rect.h, otherRect.y + otherRect.h);
+        if (overlapLeft >= overlapRight || overlapTop >= overlapBottom)
+        {
+            return false;
+        }
+
+        if (a_contactPoint_p)
+        {
+            a_contactPoint_p->x = (overlapLeft + overlapRight) * 0.5f;
+            a_contactPoint_p->y = (overlapTop + overlapBottom) * 0.5f;
+        }
+
+        if constexpr (!TRect::Solid || !TOtherRect::Solid || (!TRect::Moving && !TOtherRect::Moving))
+        {
+            return true;
+        }
+        else
+        {
+            // The normal points from the rect to the other one along the separation axis
+            const bool separateX = overlapRight - overlapLeft < overlapBottom - overlapTop;
+            const float penetration = separateX ? overlapRight - overlapLeft : overlapBottom - overlapTop;
+            const float rectCenter = separateX ? rect.x + rect.w * 0.5f : rect.y + rect.h * 0.5f;
+            const float otherRectCenter = separateX ? otherRect.x + otherRect.w * 0.5f : otherRect.y + otherRect.h * 0.5f;
+            const float normal = otherRectCenter >= rectCenter ? 1.0f : -1.0f;
+
+            constexpr float rectShare = !TOtherRect::Moving ? 1.0f : (!TRect::Moving ? 0.0f : 0.5f);
+            float& position = separateX ? rect.x : rect.y;
+            float& otherPosition = separateX ? otherRect.x : otherRect.y;
+            if constexpr (TRect::Moving)
+            {
+                position -= normal * penetration * rectShare;
+
+                float& speed = separateX ? a_rect.properties.velocity->x : a_rect.properties.velocity->y;
+                if (speed * normal > 0.0f)
+                {
+                    speed = 0.0f;
+                }
+            }
+            if constexpr (TOtherRect::Moving)
+            {
+                otherPosition += normal * penetration * (1.0f - rectShare);
+
+                float& otherSpeed = separateX ? a_otherRect.properties.velocity->x : a_otherRect.properties.velocity->y;
+                if (otherSpeed * normal < 0.0f)
+                {
+                    otherSpeed = 0.0f;
+                }
+            }
+
+            return true;
+        }
+    }
+
+    // Continuous test of a circle moving by a_displacement against a static rect. On a hit returns the
+    // earliest time of impact as a fraction of the displacement and the surface normal at the contact.
+    // A circle that already overlaps the rect at the start is not reported, CircleRect resolves those.
+    inline bool
+    SweepCircleRect(const CircleGeometry& a_circle,
+                    const SDL_FPoint& a_displacement,
+                    const SDL_FRect& a_rect,
+                    float& a_timeOfImpact,
+                    SDL_FPoint& a_normal)
+    {
+        // The circle center is traced as a ray against the rect grown by the radius (a rounded rect).
+        // First against the grown rect with square corners, using the slab test on both axes.
+        const float radius = a_circle.radius;
+        const float start[2] = {a_circle.center.x, a_circle.center.y};
+        const float direction[2] = {a_displacement.x, a_displacement.y};
+        const float slabMin[2] = {a_rect.x - radius, a_rect.y - radius};
+        const float slabMax[2] = {a_rect.x + a_rect.w + radius, a_rect.y + a_rect.h + radius};
+
+        float entryTime = -std::numeric_limits<float>::max();
+        float exitTime = std::numeric_limits<float>::max();
+        int entryAxis = -1;
+        for (int axis = 0; axis < 2; axis++)
+        {
+            if (SDL_fabsf(direction[axis]) < SDL_FLT_EPSILON)
+            {
+                if (start[axis] < slabMin[axis] || start[axis] > slabMax[axis])
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            const float minTime = (slabMin[axis] - start[axis]) / direction[axis];
+            const float maxTime = (slabMax[axis] - start[axis]) / direction[axis];
+            const float nearTime = SDL_min(minTime, maxTime);
+            const float farTime = SDL_max(minTime, maxTime);
+
+            if (nearTime > entryTime)
+            {
+                entryTime = nearTime;
+                entryAxis = axis;
+            }
+            exitTime = SDL_min(exitTime, farTime);
+        }
+
+        if (entryTime > exitTime || exitTime < 0.0f || entryTime > 1.0f)
+        {
+            return false;
+        }
+
+        // Where the grown rect is entered decides if the hit is on a side or in one of the rounded corners
+        const float entryClampedTime = SDL_max(entryTime, 0.0f);
+        const SDL_FPoint entryPoint{
+            start[0] + direction[0] * entryClampedTime,
+            start[1] + direction[1] * entryClampedTime
+        };
+        const bool outsideX = entryPoint.x < a_rect.x || entryPoint.x > a_rect.x + a_rect.w;
+        const bool outsideY = entryPoint.y < a_rect.y || entryPoint.y > a_rect.y + a_rect.h;
+
+        if (outsideX && outsideY)
+        {
+            // Ray against the circle around the corner: |start + t * direction - corner|^2 = radius^2
+            const SDL_FPoint corner{
+                entryPoint.x < a_rect.x ? a_rect.x : a_rect.x + a_rect.w,
+                entryPoint.y < a_rect.y ? a_rect.y : a_rect.y + a_rect.h
+            };
+            const SDL_FPoint offset{start[0] - corner.x, start[1] - corner.y};
+            const float a = direction[0] * direction[0] + direction[1] * direction[1];
+            const float b = offset.x * direction[0] + offset.y * direction[1];
+            const float c = offset.x * offset.x + offset.y * offset.y - radius * radius;
+            const float discriminant = b * b - a * c;
+
+            if (c < 0.0f || discriminant < 0.0f || a < SDL_FLT_EPSILON)
+            {
+                return false;
+            }
+
+            const float time = (-b - SDL_sqrtf(discriminant)) / a;
+            if (time < 0.0f || time > 1.0f)
+            {
+                return false;
+            }
+
+            a_timeOfImpact = time;
+            a_normal.x = (start[0] + direction[0] * time - corner.x) / radius;
+            a_normal.y = (start[1] + direction[1] * time - corner.y) / radius;
+        }
+        else
+        {
+            if (entryTime < 0.0f || entryAxis < 0)
+            {
+                // Starts inside the rounded rect already
+                return false;
+            }
+
+            a_timeOfImpact = entryTime;
+            a_normal.x = entryAxis == 0 ? (direction[0] > 0.0f ? -1.0f : 1.0f) : 0.0f;
+            a_normal.y = entryAxis == 1 ? (direction[1] > 0.0f ? -1.0f : 1.0f) : 0.0f;
+        }
+
+        // Grazing contacts or moving away from the surface are not impacts
+        return a_normal.x * direction[0] + a_normal.y * direction[1] < 0.0f;
+    }
+}
@@ -1,17 +1,25 @@
-#pragma once
-
-#include <SDL3/SDL.h>
-
-namespace Constants
-{
-    const int WINDOW_WIDTH = 600;
-    const int WINDOW_HEIGHT = 800;
-
-    const Uint64 MinDeltaTimeMillis = 1000 / 60;
-    const int CircleSegments = 32;
-
-    const int StartingBallCount = 3;
-    const float StartingBallSize = 30.0f;
-    const float StartingBallSpeed = 300.0f;
-    const float StartingPadSpeed = 450.0f;
+#pragma once
+
+#include <SDL3/SDL.h>
+
+namespace Constants
+{
+    const int WINDOW_WIDTH = 600;
+    const int WINDOW_HEIGHT = 800;
+
+    const Uint32 TargetFrameRateHz = 60;
+    const Uint32 DefaultSimulationTickRateHz = 120;
+    const int MaxCatchUpTicksPerFrame = 8;
+    const int RewindHistoryTicks = 5 * DefaultSimulationTickRateHz;
+    const int RewindStepTicks = DefaultSimulationTickRateHz;
+    const int MinCircleSegments = 8;
+    const int MaxCircleSegments = 64;
+
+    const int StartingBallCount = 3;
+    const float StartingBallSize = 30.0f;
+    const float StartingBallSpeed = 300.0f;
+    const float StartingPadSpeed = 450.0f;
+
+    const int MultiBallSpawnCount = 2;
+    const size_t MaxBallsInPlay = 1000;
 }
\ No newline at end of file
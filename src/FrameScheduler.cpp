@@ -0,0 +1,160 @@
+#include "FrameScheduler.hpp"
+
+FrameScheduler::FrameScheduler(const Uint32 a_targetFps)
+    : m_targetFps(SDL_max(a_targetFps, 1u))
+    , m_pacing(FramePacing::Sleep)
+    , m_scheduleStartNS(0)
+    , m_frameIndex(0)
+    , m_frameStartNS(0)
+    , m_resumed(false)
+{
+    ResetStats();
+}
+
+void
+FrameScheduler::SetTargetFps(const Uint32 a_targetFps)
+{
+    m_targetFps = SDL_max(a_targetFps, 1u);
+    restartSchedule(SDL_GetTicksNS());
+}
+
+void
+FrameScheduler::SetPacing(const FramePacing a_pacing)
+{
+    m_pacing = a_pacing;
+    restartSchedule(SDL_GetTicksNS());
+}
+
+FramePacing
+FrameScheduler::Pacing() const
+{
+    return m_pacing;
+}
+
+Uint64
+FrameScheduler::BeginFrame()
+{
+    const Uint64 nowNS = SDL_GetTicksNS();
+
+    if (m_frames == 0)
+    {
+        m_statsStartNS = nowNS;
+        if (m_scheduleStartNS == 0)
+        {
+            restartSchedule(nowNS);
+        }
+    }
+    else if (!m_resumed)
+    {
+        const Uint64 frameTimeNS = nowNS - m_frameStartNS;
+        const Uint64 targetNS = targetFrameNS();
+        const Uint64 deviationNS = frameTimeNS > targetNS ? frameTimeNS - targetNS : targetNS - frameTimeNS;
+
+        m_frameIntervals++;
+        m_frameTimeSumNS += (double)frameTimeNS;
+        m_frameTimeSquareSumNS += (double)frameTimeNS * (double)frameTimeNS;
+        m_maxFrameDeviationNS = SDL_max(m_maxFrameDeviationNS, deviationNS);
+    }
+
+    m_frames++;
+    m_frameStartNS = nowNS;
+    m_resumed = false;
+
+    return nowNS;
+}
+
+void
+FrameScheduler::EndFrame()
+{
+    const Uint64 endNS = SDL_GetTicksNS();
+    m_busyNS += endNS - m_frameStartNS;
+
+    if (m_pacing == FramePacing::VSync)
+    {
+        return;
+    }
+
+    // Deadline n is start + n * 1e9 / fps, computed in whole nanoseconds from the schedule start
+    m_frameIndex++;
+    const Uint64 deadlineNS = m_scheduleStartNS + m_frameIndex * SDL_NS_PER_SECOND / m_targetFps;
+    if (endNS >= deadlineNS)
+    {
+        // The frame overran its slot, start a new schedule instead of rushing frames to catch up
+        m_missedDeadlines++;
+        restartSchedule(endNS);
+        return;
+    }
+
+    SDL_DelayPrecise(deadlineNS - endNS);
+
+    const Uint64 wakeUpNS = SDL_GetTicksNS();
+    m_sleeps++;
+    m_wakeUpDelaySumNS += wakeUpNS > deadlineNS ? wakeUpNS - deadlineNS : 0;
+}
+
+void
+FrameScheduler::Resume()
+{
+    m_resumed = true;
+    restartSchedule(SDL_GetTicksNS());
+}
+
+FrameSchedulerStats
+FrameScheduler::GetStats() const
+{
+    FrameSchedulerStats stats;
+    stats.frames = m_frames;
+    stats.missedDeadlines = m_missedDeadlines;
+
+    if (m_frameIntervals > 0)
+    {
+        const double averageNS = m_frameTimeSumNS / m_frameIntervals;
+        const double varianceNS = SDL_max(m_frameTimeSquareSumNS / m_frameIntervals - averageNS * averageNS, 0.0);
+        stats.averageFrameMS = averageNS / SDL_NS_PER_MS;
+        stats.averageFps = averageNS > 0.0 ? SDL_NS_PER_SECOND / averageNS : 0.0;
+        stats.frameJitterMS = SDL_sqrt(varianceNS) / SDL_NS_PER_MS;
+        stats.frameTimeVarianceMS2 = varianceNS / ((double)SDL_NS_PER_MS * SDL_NS_PER_MS);
+        stats.maxFrameDeviationMS = (double)m_maxFrameDeviationNS / SDL_NS_PER_MS;
+    }
+
+    if (m_sleeps > 0)
+    {
+        stats.averageWakeUpDelayMS = (double)m_wakeUpDelaySumNS / m_sleeps / SDL_NS_PER_MS;
+    }
+
+    const Uint64 elapsedNS = m_frames > 0 ? SDL_GetTicksNS() - m_statsStartNS : 0;
+    if (elapsedNS > 0)
+    {
+        stats.busyFraction = SDL_min((double)m_busyNS / elapsedNS, 1.0);
+    }
+
+    return stats;
+}
+
+void
+FrameScheduler::ResetStats()
+{
+    m_statsStartNS = 0;
+    m_frames = 0;
+    m_frameIntervals = 0;
+    m_frameTimeSumNS = 0.0;
+    m_frameTimeSquareSumNS = 0.0;
+    m_maxFrameDeviationNS = 0;
+    m_busyNS = 0;
+    m_sleeps = 0;
+    m_wakeUpDelaySumNS = 0;
+    m_missedDeadlines = 0;
+}
+
+Uint64
+FrameScheduler::targetFrameNS() const
+{
+    return SDL_NS_PER_SECOND / m_targetFps;
+}
+
+void
+FrameScheduler::restartSchedule(const Uint64 a_nowNS)
+{
+    m_scheduleStartNS = a_nowNS;
+    m_frameIndex = 0;
+}
\ No newline at end of file
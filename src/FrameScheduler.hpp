@@ -0,0 +1,72 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+enum class FramePacing
+{
+    Sleep,  // Sleep until the next frame deadline
+    VSync   // Presenting waits for the display, the scheduler only measures
+};
+
+struct FrameSchedulerStats
+{
+    Uint64 frames = 0;
+    double averageFrameMS = 0.0;
+    double averageFps = 0.0;
+    double frameJitterMS = 0.0;         // Standard deviation of the frame time
+    double frameTimeVarianceMS2 = 0.0;  // Variance of the frame time, in square milliseconds
+    double maxFrameDeviationMS = 0.0;   // Largest difference of a frame time from the target frame time
+    double averageWakeUpDelayMS = 0.0;  // How late the sleeps returned after their deadline
+    double busyFraction = 0.0;          // Share of the wall time spent working instead of sleeping
+    Uint64 missedDeadlines = 0;
+};
+
+// Paces the frame loop at a target rate by sleeping until each frame deadline instead of returning
+// early and getting called again in a tight loop. Deadlines are computed from the start of the schedule
+// in nanoseconds, so the frame time does not drift from rounding. The sleep happens at the end of a
+// frame, events that arrive meanwhile are handled before the next frame starts.
+class FrameScheduler
+{
+public:
+    explicit FrameScheduler(const Uint32 a_targetFps);
+    virtual ~FrameScheduler() = default;
+
+    void SetTargetFps(const Uint32 a_targetFps);
+    void SetPacing(const FramePacing a_pacing);
+    FramePacing Pacing() const;
+
+    // Marks the start of a frame and returns its time in nanoseconds
+    Uint64 BeginFrame();
+    // Marks the end of the frame's work and sleeps until the next frame is due
+    void EndFrame();
+    // Starts a new schedule after the loop waited for events instead of rendering, the wait does not
+    // count as a frame time
+    void Resume();
+
+    FrameSchedulerStats GetStats() const;
+    void ResetStats();
+
+private:
+    Uint64 targetFrameNS() const;
+    void restartSchedule(const Uint64 a_nowNS);
+
+private:
+    Uint32 m_targetFps;
+    FramePacing m_pacing;
+
+    Uint64 m_scheduleStartNS;
+    Uint64 m_frameIndex;
+    Uint64 m_frameStartNS;
+    bool m_resumed;
+
+    Uint64 m_statsStartNS;
+    Uint64 m_frames;
+    Uint64 m_frameIntervals;
+    double m_frameTimeSumNS;
+    double m_frameTimeSquareSumNS;
+    Uint64 m_maxFrameDeviationNS;
+    Uint64 m_busyNS;
+    Uint64 m_sleeps;
+    Uint64 m_wakeUpDelaySumNS;
+    Uint64 m_missedDeadlines;
+};
\ No newline at end of file
@@ -1,95 +1,328 @@
-#include "Game.hpp"
-
-#include "Constants.hpp"
-#include "GeometryEngine.hpp"
-#include "LevelController.hpp"
-#include "LevelFactory.hpp"
-#include "Renderer.hpp"
-
-Game::Game(std::shared_ptr<Renderer> a_renderer_sp,
-           std::shared_ptr<LevelFactory> a_levelFactory_sp,
-           std::shared_ptr<GeometryEngine> a_geometryEngine_sp)
-    : m_renderer_sp(a_renderer_sp)
-    , m_levelFactory_sp(a_levelFactory_sp)
-    , m_geometryEngine_sp(a_geometryEngine_sp)
-    , m_currentLevel_sp(nullptr)
-    , m_lastTimeMillis(0)
-{
-}
-
-SDL_AppResult
-Game::Iterate()
-{
-    const Uint64 now = SDL_GetTicks();
-    const Uint64 deltaMillis = now - m_lastTimeMillis;
-    
-    if (deltaMillis < Constants::MinDeltaTimeMillis)
-    {
-        return SDL_APP_CONTINUE;
-    }
-
-    m_lastTimeMillis = now;
-    const float deltaSeconds = deltaMillis / 1000.0f;
-
-    if (!m_currentLevel_sp)
-    {
-        m_renderer_sp->RenderTitleScreen();
-    }
-
-    if (m_currentLevel_sp)
-    {
-        if (m_currentLevel_sp->GameOver())
-        {
-            m_renderer_sp->RenderFinalScore(m_currentLevel_sp->GetLevel().balls >= 0, m_currentLevel_sp->GetLevel().score);
-        }
-        else
-        {
-            m_currentLevel_sp->Iterate(deltaSeconds);
-            m_renderer_sp->RenderLevel(m_currentLevel_sp->GetLevel());
-        }
-    }
-
-    return SDL_APP_CONTINUE;
-}
-
-SDL_AppResult
-Game::HandleInput(void* a_appstate_p, SDL_Event* a_event_p)
-{
-    if (a_event_p->type == SDL_EVENT_QUIT || (a_event_p->type == SDL_EVENT_KEY_DOWN && a_event_p->key.key == SDLK_ESCAPE))
-    {
-        return SDL_APP_SUCCESS;
-    }
-
-    if (m_currentLevel_sp && !m_currentLevel_sp->GameOver())
-    {
-        switch (a_event_p->type)
-        {
-            case SDL_EVENT_KEY_DOWN:
-            case SDL_EVENT_KEY_UP:
-                m_currentLevel_sp->HandleKeyboardEvent(a_event_p->key);
-                break;
-
-            case SDL_EVENT_MOUSE_MOTION:
-                m_currentLevel_sp->HandleMouseMotionEvent(a_event_p->motion, m_renderer_sp->WindowToLevelPosition({a_event_p->motion.x, a_event_p->motion.y}));
-                break;
-
-            case SDL_EVENT_MOUSE_BUTTON_DOWN:
-            case SDL_EVENT_MOUSE_BUTTON_UP:
-                m_currentLevel_sp->HandleMouseButtonEvent(a_event_p->button, m_renderer_sp->WindowToLevelPosition({a_event_p->button.x, a_event_p->button.y}));
-                break;
-        }
-    }
-    else if (a_event_p->type == SDL_EVENT_KEY_DOWN || a_event_p->type == SDL_EVENT_MOUSE_BUTTON_DOWN)
-    {
-        if (!m_currentLevel_sp)
-        {
-            m_currentLevel_sp = std::make_shared<LevelController>(m_geometryEngine_sp, m_levelFactory_sp->CreateLevel(m_renderer_sp->LevelBounds()));
-        }
-        else
-        {
-            return SDL_APP_SUCCESS;
-        }
-    }
-
-    return SDL_APP_CONTINUE;
+#include "Game.hpp"
+
+#include "Constants.hpp"
+#include "GeometryEngine.hpp"
+#include "LevelFactory.hpp"
+#include "Profiler.hpp"
+#include "Renderer.hpp"
+
+Game::Game(std::shared_ptr<Renderer> a_renderer_sp,
+           std::shared_ptr<LevelFactory> a_levelFactory_sp,
+           std::shared_ptr<GeometryEngine> a_geometryEngine_sp)
+    : m_renderer_sp(a_renderer_sp)
+    , m_levelFactory_sp(a_levelFactory_sp)
+    , m_geometryEngine_sp(a_geometryEngine_sp)
+    , m_startLevelValid(false)
+    , m_frameScheduler(Constants::TargetFrameRateHz)
+    , m_matchDisplayRefresh(false)
+    , m_idleWait(false)
+    , m_staticScreenDrawn(false)
+    , m_simulationThread(a_geometryEngine_sp)
+    , m_levelStart(0)
+    , m_pushedInputs(0)
+{
+}
+
+void
+Game::SetSimulationTickRate(const Uint32 a_tickRateHz)
+{
+    m_simulationThread.SetTickRate(a_tickRateHz);
+}
+
+void
+Game::SetVSync(const bool a_enabled)
+{
+    const bool vsyncEnabled = m_renderer_sp->SetVSync(a_enabled) && a_enabled;
+    m_frameScheduler.SetPacing(vsyncEnabled ? FramePacing::VSync : FramePacing::Sleep);
+}
+
+void
+Game::SetMatchDisplayRefresh(const bool a_enabled)
+{
+    m_matchDisplayRefresh = a_enabled;
+    updateTargetFrameRate();
+}
+
+void
+Game::SetIdleWait(const bool a_enabled)
+{
+    m_idleWait = a_enabled;
+}
+
+void
+Game::updateTargetFrameRate()
+{
+    Uint32 targetFps = Constants::TargetFrameRateHz;
+    if (m_matchDisplayRefresh)
+    {
+        const float refreshRate = m_renderer_sp->DisplayRefreshRate();
+        if (refreshRate > 0.0f)
+        {
+            targetFps = (Uint32)SDL_lroundf(refreshRate);
+        }
+        else
+        {
+            SDL_Log("Couldn't get the display refresh rate, rendering at %u FPS", targetFps);
+        }
+    }
+
+    m_frameScheduler.SetTargetFps(targetFps);
+}
+
+void
+Game::SetLevelFile(const std::string& a_path)
+{
+    m_levelPath = a_path;
+    m_startLevelValid = false;
+}
+
+void
+Game::SetStressLevel(const StressLevelOptions& a_options)
+{
+    m_stressLevelOptions = a_options;
+    m_stressLevelOptions->fitBounds = true;
+    m_startLevelValid = false;
+}
+
+void
+Game::StartRecording(const std::string& a_path)
+{
+    m_recordingPath = a_path;
+}
+
+void
+Game::Stop()
+{
+    m_simulationThread.Stop();
+}
+
+SDL_AppResult
+Game::Iterate()
+{
+    // The simulation runs on, rendering takes whichever state it published last
+    const SimulationFrame* frame_p = m_simulationThread.Running() ? m_simulationThread.AcquireFrame() : nullptr;
+    const bool drawingStaticScreen = staticScreen(frame_p);
+    if (m_idleWait && drawingStaticScreen && m_staticScreenDrawn)
+    {
+        // Leaves the event in the queue, SDL hands it to HandleInput before the next iteration
+        SDL_WaitEvent(nullptr);
+        m_frameScheduler.Resume();
+        return SDL_APP_CONTINUE;
+    }
+
+    m_frameScheduler.BeginFrame();
+
+    {
+        ARKANOID_PROFILE_SCOPE(ProfilePhase::Frame);
+
+        if (!frame_p)
+        {
+            m_renderer_sp->RenderTitleScreen();
+        }
+        else if (levelOver(frame_p))
+        {
+            m_renderer_sp->RenderFinalScore(frame_p->level.balls >= 0, frame_p->level.score);
+        }
+        else if (m_matchDisplayRefresh)
+        {
+            m_renderer_sp->SetRewindAvailable(frame_p->rewindAvailable);
+            m_renderer_sp->RenderLevel(frame_p->level, frame_p->motion, frame_p->motion.Alpha(SDL_GetTicksNS()), &frame_p->brickChanges);
+            m_simulationThread.MarkPresented(SDL_GetTicksNS(), *frame_p);
+        }
+        else
+        {
+            m_renderer_sp->SetRewindAvailable(frame_p->rewindAvailable);
+            m_renderer_sp->RenderLevel(frame_p->level, &frame_p->brickChanges);
+            m_simulationThread.MarkPresented(SDL_GetTicksNS(), *frame_p);
+        }
+    }
+
+    m_staticScreenDrawn = drawingStaticScreen;
+    m_frameScheduler.EndFrame();
+
+    return SDL_APP_CONTINUE;
+}
+
+bool
+Game::staticScreen(const SimulationFrame* a_frame_p) const
+{
+    if (!a_frame_p)
+    {
+        return true;
+    }
+
+    return a_frame_p->appliedInputs == m_pushedInputs && (levelOver(a_frame_p) || a_frame_p->level.paused);
+}
+
+bool
+Game::levelOver(const SimulationFrame* a_frame_p) const
+{
+    return a_frame_p && a_frame_p->gameOver && a_frame_p->levelStart == m_levelStart;
+}
+
+void
+Game::startLevel()
+{
+    if (!m_startLevelValid)
+    {
+        createLevel(m_startLevel);
+        m_startLevelValid = true;
+    }
+
+    if (!m_recordingPath.empty())
+    {
+        if (!m_levelPath.empty() || m_stressLevelOptions)
+        {
+            // Replays always rebuild the built-in level
+            SDL_Log("Recording only supports the built-in level, the level is not recorded");
+        }
+        else if (m_simulationThread.TickRateHz() > 0)
+        {
+            m_simulationThread.SetRecordingPath(m_recordingPath);
+        }
+        else
+        {
+            SDL_Log("Recording needs a fixed simulation tick rate, the level is not recorded");
+        }
+    }
+
+    m_simulationThread.Start(m_startLevel, SDL_GetTicksNS());
+}
+
+void
+Game::pushInput(const InputCommand a_command, const SDL_Event& a_event, const SDL_FPoint& a_levelPosition)
+{
+    TimedInput input;
+    input.command = a_command;
+    input.event = a_event;
+    input.levelPosition = a_levelPosition;
+
+    // The simulation drains the queue every tick, it only fills up when the simulation thread stalls
+    if (!m_simulationThread.PushInput(input))
+    {
+        SDL_Log("Input queue is full, dropping input");
+        return;
+    }
+
+    m_pushedInputs++;
+    if (a_command == InputCommand::Restart)
+    {
+        m_levelStart++;
+    }
+}
+
+void
+Game::createLevel(Level& a_level) const
+{
+    const SDL_FRect levelBounds = m_renderer_sp->LevelBounds();
+    if (m_stressLevelOptions)
+    {
+        m_levelFactory_sp->CreateStressLevel(levelBounds, *m_stressLevelOptions, a_level);
+        return;
+    }
+
+    if (!m_levelPath.empty() && m_levelFactory_sp->LoadLevel(m_levelPath.c_str(), levelBounds, a_level))
+    {
+        return;
+    }
+
+    if (!m_levelPath.empty())
+    {
+        SDL_Log("Couldn't load level %s, playing the built-in level", m_levelPath.c_str());
+    }
+    m_levelFactory_sp->CreateLevel(levelBounds, a_level);
+}
+
+SDL_AppResult
+Game::HandleInput(void* a_appstate_p, SDL_Event* a_event_p)
+{
+    if (a_event_p->type == SDL_EVENT_QUIT || (a_event_p->type == SDL_EVENT_KEY_DOWN && a_event_p->key.key == SDLK_ESCAPE))
+    {
+        return SDL_APP_SUCCESS;
+    }
+
+#ifdef ARKANOID_PROFILING
+    if (a_event_p->type == SDL_EVENT_KEY_DOWN && a_event_p->key.key == SDLK_F3 && !a_event_p->key.repeat)
+    {
+        m_renderer_sp->SetProfilerOverlayVisible(!m_renderer_sp->ProfilerOverlayVisible());
+        return SDL_APP_CONTINUE;
+    }
+#endif
+
+    // Render target contents are lost, the renderer rebuilds its cached layers on the next frame
+    if (a_event_p->type == SDL_EVENT_RENDER_TARGETS_RESET || a_event_p->type == SDL_EVENT_RENDER_DEVICE_RESET)
+    {
+        m_renderer_sp->ResetRenderCaches();
+        return SDL_APP_CONTINUE;
+    }
+
+    // Any event may change what a static screen shows, or uncover the window
+    m_staticScreenDrawn = false;
+
+    // The window moved to another display or the display switched modes
+    if (a_event_p->type == SDL_EVENT_WINDOW_DISPLAY_CHANGED || a_event_p->type == SDL_EVENT_DISPLAY_CURRENT_MODE_CHANGED)
+    {
+        if (m_matchDisplayRefresh)
+        {
+            updateTargetFrameRate();
+        }
+        return SDL_APP_CONTINUE;
+    }
+
+    if (!m_simulationThread.Running())
+    {
+        if (a_event_p->type == SDL_EVENT_KEY_DOWN || a_event_p->type == SDL_EVENT_MOUSE_BUTTON_DOWN)
+        {
+            startLevel();
+        }
+        return SDL_APP_CONTINUE;
+    }
+
+    const bool restartPressed = a_event_p->type == SDL_EVENT_KEY_DOWN && a_event_p->key.key == SDLK_R && !a_event_p->key.repeat;
+    const bool rewindPressed = a_event_p->type == SDL_EVENT_KEY_DOWN && a_event_p->key.key == SDLK_BACKSPACE;
+    if (restartPressed)
+    {
+        pushInput(InputCommand::Restart, *a_event_p, {0.0f, 0.0f});
+    }
+    else if (rewindPressed)
+    {
+        pushInput(InputCommand::Rewind, *a_event_p, {0.0f, 0.0f});
+    }
+    else if (!levelOver(m_simulationThread.AcquireFrame()))
+    {
+        switch (a_event_p->type)
+        {
+            case SDL_EVENT_KEY_DOWN:
+            case SDL_EVENT_KEY_UP:
+                pushInput(InputCommand::LevelEvent, *a_event_p, {0.0f, 0.0f});
+                break;
+
+            case SDL_EVENT_MOUSE_MOTION:
+                pushInput(InputCommand::LevelEvent, *a_event_p, m_renderer_sp->WindowToLevelPosition({a_event_p->motion.x, a_event_p->motion.y}));
+                break;
+
+            case SDL_EVENT_MOUSE_BUTTON_DOWN:
+            case SDL_EVENT_MOUSE_BUTTON_UP:
+                pushInput(InputCommand::LevelEvent, *a_event_p, m_renderer_sp->WindowToLevelPosition({a_event_p->button.x, a_event_p->button.y}));
+                break;
+        }
+    }
+    else if (a_event_p->type == SDL_EVENT_KEY_DOWN || a_event_p->type == SDL_EVENT_MOUSE_BUTTON_DOWN)
+    {
+        return SDL_APP_SUCCESS;
+    }
+
+    return SDL_APP_CONTINUE;
+}
+
+FrameSchedulerStats
+Game::GetFrameStats() const
+{
+    return m_frameScheduler.GetStats();
+}
+
+InputLatencyStats
+Game::GetInputLatencyStats() const
+{
+    return m_simulationThread.GetInputLatencyStats();
 }
\ No newline at end of file
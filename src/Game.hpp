@@ -1,30 +1,86 @@
-#pragma once
-
-#include <SDL3/SDL.h>
-
-#include <memory>
-
-class GeometryEngine;
-class LevelController;
-class LevelFactory;
-class Renderer;
-
-class Game
-{
-public:
-    explicit Game(std::shared_ptr<Renderer> a_renderer_sp,
-                  std::shared_ptr<LevelFactory> a_levelFactory_sp,
-                  std::shared_ptr<GeometryEngine> a_geometryEngine_sp);
-    virtual ~Game() = default;
-
-    SDL_AppResult Iterate();
-    SDL_AppResult HandleInput(void* a_appstate_p, SDL_Event* a_event_p);
-
-private:
-    std::shared_ptr<Renderer> m_renderer_sp;
-    std::shared_ptr<LevelFactory> m_levelFactory_sp;
-    std::shared_ptr<GeometryEngine> m_geometryEngine_sp;
-
-    std::shared_ptr<LevelController> m_currentLevel_sp;
-    Uint64 m_lastTimeMillis;
-};
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include "FrameScheduler.hpp"
+#include "InputQueue.hpp"
+#include "LevelFactory.hpp"
+#include "SimulationThread.hpp"
+#include "gameobjects/Level.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+class GeometryEngine;
+class Renderer;
+
+class Game
+{
+public:
+    explicit Game(std::shared_ptr<Renderer> a_renderer_sp,
+                  std::shared_ptr<LevelFactory> a_levelFactory_sp,
+                  std::shared_ptr<GeometryEngine> a_geometryEngine_sp);
+    virtual ~Game() = default;
+
+    // 0 selects the variable timestep mode, where each step simulates the whole elapsed time at once
+    void SetSimulationTickRate(const Uint32 a_tickRateHz);
+    // Paces frames with the display refresh instead of sleeping, falls back to sleeping when the
+    // renderer cannot enable vsync
+    void SetVSync(const bool a_enabled);
+    // Renders at the refresh rate of the window's display instead of the default frame rate. Frames then
+    // come faster than simulation ticks, the pad and the balls are drawn interpolated between the last
+    // two simulation states, a tick behind the simulation.
+    void SetMatchDisplayRefresh(const bool a_enabled);
+    // Draws the title, pause and final score screens once and then waits for events instead of drawing
+    // the same frame again, frames are only drawn continuously while the level is running
+    void SetIdleWait(const bool a_enabled);
+
+    // Plays the level from this level file instead of the built-in one
+    void SetLevelFile(const std::string& a_path);
+    // Plays a generated stress level fitted into the window instead, takes precedence over a level file
+    void SetStressLevel(const StressLevelOptions& a_options);
+
+    // Records every level played from now on into a_path, the previous level gets overwritten
+    void StartRecording(const std::string& a_path);
+    // Stops the simulation thread, a recording in progress is saved
+    void Stop();
+
+    SDL_AppResult Iterate();
+    SDL_AppResult HandleInput(void* a_appstate_p, SDL_Event* a_event_p);
+
+    FrameSchedulerStats GetFrameStats() const;
+    // Time from the SDL timestamp of a level input to the present of the first frame showing its effect
+    InputLatencyStats GetInputLatencyStats() const;
+
+private:
+    // Only the first start builds the level and starts the simulation, restarts reuse both
+    void startLevel();
+    void createLevel(Level& a_level) const;
+    // Game over in the current level, not in one that was restarted since
+    bool levelOver(const SimulationFrame* a_frame_p) const;
+    // Nothing on the screen can change without an event, the simulation has applied all input so far
+    bool staticScreen(const SimulationFrame* a_frame_p) const;
+    void updateTargetFrameRate();
+    void pushInput(const InputCommand a_command, const SDL_Event& a_event, const SDL_FPoint& a_levelPosition);
+
+private:
+    std::shared_ptr<Renderer> m_renderer_sp;
+    std::shared_ptr<LevelFactory> m_levelFactory_sp;
+    std::shared_ptr<GeometryEngine> m_geometryEngine_sp;
+
+    Level m_startLevel;
+    bool m_startLevelValid;
+    FrameScheduler m_frameScheduler;
+    bool m_matchDisplayRefresh;
+    bool m_idleWait;
+    bool m_staticScreenDrawn;
+    SimulationThread m_simulationThread;
+    // Restarts requested so far, compared with the restarts the published frames have seen
+    Uint32 m_levelStart;
+    Uint64 m_pushedInputs;
+
+    std::string m_levelPath;
+    std::optional<StressLevelOptions> m_stressLevelOptions;
+    std::string m_recordingPath;
+};
@@ -1,173 +1,214 @@
-#include "GeometryEngine.hpp"
-
-#include "gameobjects/ObjectGeometry.hpp"
-
-#include <SDL3/SDL.h>
-
-void
-GeometryEngine::SimulateMovement(CircleGeometry& a_circle, const float a_deltaSeconds) const
-{
-    if (a_circle.properties.velocity.has_value())
-    {
-        a_circle.center.x += a_circle.properties.velocity->x * a_deltaSeconds;
-        a_circle.center.y += a_circle.properties.velocity->y * a_deltaSeconds;
-    }
-}
-
-void
-GeometryEngine::SimulateMovement(RectGeometry& a_rect, const float a_deltaSeconds) const
-{
-    if (a_rect.properties.velocity.has_value())
-    {
-        a_rect.rect.x += a_rect.properties.velocity->x * a_deltaSeconds;
-        a_rect.rect.y += a_rect.properties.velocity->y * a_deltaSeconds;
-    }
-}
-
-bool
-GeometryEngine::ProcessCollision(CircleGeometry& a_circle, RectGeometry& a_rect, SDL_FPoint* a_contactPoint_p) const
-{
-    bool centerIsInsideRect = false;
-    const SDL_FPoint closestPoint = getClosestPointOnRect(a_circle, a_rect, centerIsInsideRect);
-    SDL_FPoint distanceToClosestPoint{
-        a_circle.center.x - closestPoint.x,
-        a_circle.center.y - closestPoint.y
-    };
-
-    // Avoding more calculations for obvious non-collisions
-    if (!centerIsInsideRect && (SDL_abs(distanceToClosestPoint.x) + SDL_abs(distanceToClosestPoint.y)) > a_circle.radius)
-    {
-        return false;
-    }
-
-    const float distanceSquared = distanceToClosestPoint.x * distanceToClosestPoint.x +
-                                    distanceToClosestPoint.y * distanceToClosestPoint.y;
-    if (centerIsInsideRect || distanceSquared < (a_circle.radius * a_circle.radius))
-    {
-        if (a_contactPoint_p)
-        {
-            *a_contactPoint_p = closestPoint;
-        }
-        
-        if (!a_circle.properties.isSolid || !a_rect.properties.isSolid || !a_circle.properties.velocity.has_value())
-        {
-            return true;
-        }
-
-        if (centerIsInsideRect)
-        {
-            // Push circle out to the edge of the rectangle, whichever direction is shortest
-            if (SDL_abs(distanceToClosestPoint.x) > SDL_abs(distanceToClosestPoint.y))
-            {
-                a_circle.center.x = closestPoint.x + (distanceToClosestPoint.x > 0 ? -a_circle.radius : a_circle.radius);
-                a_circle.center.y = closestPoint.y;
-            }
-            else
-            {
-                a_circle.center.x = closestPoint.x;
-                a_circle.center.y = closestPoint.y + (distanceToClosestPoint.y > 0 ? -a_circle.radius : a_circle.radius);
-            }
-
-            distanceToClosestPoint.x = a_circle.center.x - closestPoint.x;
-            distanceToClosestPoint.y = a_circle.center.y - closestPoint.y;
-        }
-
-        const float normalLength = SDL_sqrtf(distanceSquared);
-        const SDL_FPoint normal{
-            distanceToClosestPoint.x / normalLength,
-            distanceToClosestPoint.y / normalLength
-        };
-
-        SDL_FPoint& velocity = a_circle.properties.velocity.value();
-        const float velocityDotNormal = velocity.x * normal.x + velocity.y * normal.y;
-
-        if (velocityDotNormal > 0)
-        {
-            // Moving away from the surface, no collision
-            return false;
-        }
-
-        a_circle.center.x = closestPoint.x + normal.x * a_circle.radius;
-        a_circle.center.y = closestPoint.y + normal.y * a_circle.radius;
-        velocity.x -= 2.0f * velocityDotNormal * normal.x;
-        velocity.y -= 2.0f * velocityDotNormal * normal.y;
-
-        if (SDL_isnan(velocity.x) || SDL_isnan(velocity.y) || SDL_isnan(a_circle.center.x) || SDL_isnan(a_circle.center.y))
-        {
-            velocity.x = 0.0f;
-            velocity.y = 0.0f;
-        }
-
-        return true;
-    }
-
-    return false;
-}
-
-SDL_FPoint
-GeometryEngine::RotateVector(const SDL_FPoint a_vector, const float a_angleRad) const
-{
-    const float cosAngle = SDL_cosf(a_angleRad);
-    const float sinAngle = SDL_sinf(a_angleRad);
-
-    return {
-        a_vector.x * cosAngle + a_vector.y * sinAngle,
-        a_vector.x * sinAngle + a_vector.y * cosAngle,
-    };
-}
-
-SDL_FPoint
-GeometryEngine::getClosestPointOnRect(const CircleGeometry &a_circle, const RectGeometry &a_rect, bool& a_isInsideRect) const
-{
-    if (SDL_PointInRectFloat(&a_circle.center, &a_rect.rect))
-    {
-        a_isInsideRect = true;
-        SDL_FPoint closestPointsOnEdges[4];
-
-        // Left
-        closestPointsOnEdges[0] = {
-            a_rect.rect.x,
-            a_circle.center.y
-        };
-        // Right
-        closestPointsOnEdges[1] = {
-            a_rect.rect.x + a_rect.rect.w,
-            a_circle.center.y
-        };
-        // Top
-        closestPointsOnEdges[2] = {
-            a_circle.center.x,
-            a_rect.rect.y
-        };
-        // Bottom
-        closestPointsOnEdges[3] = {
-            a_circle.center.x,
-            a_rect.rect.y + a_rect.rect.h
-        };
-        
-        int closestPointIndex = 0;
-        float closestDistanceSquared = 0.0f;
-        for (int i = 0; i < SDL_arraysize(closestPointsOnEdges); i++)
-        {
-            const SDL_FPoint& difference{
-                a_circle.center.x - closestPointsOnEdges[i].x,
-                a_circle.center.y - closestPointsOnEdges[i].y
-            };
-            const float currentDistanceSquared = (difference.x * difference.x) + (difference.y * difference.y);
-
-            if (i == 0 || currentDistanceSquared < closestDistanceSquared)
-            {
-                closestPointIndex = i;
-                closestDistanceSquared = currentDistanceSquared;
-            }
-        }
-        
-        return closestPointsOnEdges[closestPointIndex];
-    }
-
-    a_isInsideRect = false;
-    return {
-        SDL_clamp(a_circle.center.x, a_rect.rect.x, a_rect.rect.x + a_rect.rect.w),
-        SDL_clamp(a_circle.center.y, a_rect.rect.y, a_rect.rect.y + a_rect.rect.h)
-    };
-}
+#include "GeometryEngine.hpp"
+
+#include "CollisionKernels.hpp"
+#include "gameobjects/ObjectGeometry.hpp"
+
+#include <SDL3/SDL.h>
+
+namespace
+{
+
+int
+countSetBits(Uint32 a_bits)
+{
+    int count = 0;
+    while (a_bits)
+    {
+        a_bits &= a_bits - 1;
+        count++;
+    }
+
+    return count;
+}
+
+}
+
+void
+GeometryEngine::SimulateMovement(CircleGeometry& a_circle, const float a_deltaSeconds) const
+{
+    if (a_circle.properties.velocity.has_value())
+    {
+        a_circle.center.x += a_circle.properties.velocity->x * a_deltaSeconds;
+        a_circle.center.y += a_circle.properties.velocity->y * a_deltaSeconds;
+    }
+}
+
+void
+GeometryEngine::SimulateMovement(RectGeometry& a_rect, const float a_deltaSeconds) const
+{
+    if (a_rect.properties.velocity.has_value())
+    {
+        a_rect.rect.x += a_rect.properties.velocity->x * a_deltaSeconds;
+        a_rect.rect.y += a_rect.properties.velocity->y * a_deltaSeconds;
+    }
+}
+
+bool
+GeometryEngine::ProcessCollision(CircleGeometry& a_circle, RectGeometry& a_rect, SDL_FPoint* a_contactPoint_p) const
+{
+    if (a_circle.properties.isSolid && a_rect.properties.isSolid && a_circle.properties.velocity.has_value())
+    {
+        return CollisionKernels::CircleRect<MovingSolidBody, StaticSolidBody>(a_circle, a_rect.rect, a_contactPoint_p);
+    }
+
+    return CollisionKernels::CircleRect<StaticSensorBody, StaticSensorBody>(a_circle, a_rect.rect, a_contactPoint_p);
+}
+
+bool
+GeometryEngine::ProcessCollision(CircleGeometry& a_circle, CircleGeometry& a_otherCircle, SDL_FPoint* a_contactPoint_p) const
+{
+    if (!a_circle.properties.isSolid || !a_otherCircle.properties.isSolid)
+    {
+        return CollisionKernels::CircleCircle<StaticSensorBody, StaticSensorBody>(a_circle, a_otherCircle, a_contactPoint_p);
+    }
+
+    const bool circleMoves = a_circle.properties.velocity.has_value();
+    const bool otherCircleMoves = a_otherCircle.properties.velocity.has_value();
+    if (circleMoves && otherCircleMoves)
+    {
+        return CollisionKernels::CircleCircle<MovingSolidBody, MovingSolidBody>(a_circle, a_otherCircle, a_contactPoint_p);
+    }
+    if (circleMoves)
+    {
+        return CollisionKernels::CircleCircle<MovingSolidBody, StaticSolidBody>(a_circle, a_otherCircle, a_contactPoint_p);
+    }
+    if (otherCircleMoves)
+    {
+        return CollisionKernels::CircleCircle<StaticSolidBody, MovingSolidBody>(a_circle, a_otherCircle, a_contactPoint_p);
+    }
+
+    return CollisionKernels::CircleCircle<StaticSolidBody, StaticSolidBody>(a_circle, a_otherCircle, a_contactPoint_p);
+}
+
+bool
+GeometryEngine::ProcessCollision(RectGeometry& a_rect, RectGeometry& a_otherRect, SDL_FPoint* a_contactPoint_p) const
+{
+    if (!a_rect.properties.isSolid || !a_otherRect.properties.isSolid)
+    {
+        return CollisionKernels::RectRect<StaticSensorBody, StaticSensorBody>(a_rect, a_otherRect, a_contactPoint_p);
+    }
+
+    const bool rectMoves = a_rect.properties.velocity.has_value();
+    const bool otherRectMoves = a_otherRect.properties.velocity.has_value();
+    if (rectMoves && otherRectMoves)
+    {
+        return CollisionKernels::RectRect<MovingSolidBody, MovingSolidBody>(a_rect, a_otherRect, a_contactPoint_p);
+    }
+    if (rectMoves)
+    {
+        return CollisionKernels::RectRect<MovingSolidBody, StaticSolidBody>(a_rect, a_otherRect, a_contactPoint_p);
+    }
+    if (otherRectMoves)
+    {
+        return CollisionKernels::RectRect<StaticSolidBody, MovingSolidBody>(a_rect, a_otherRect, a_contactPoint_p);
+    }
+
+    return CollisionKernels::RectRect<StaticSolidBody, StaticSolidBody>(a_rect, a_otherRect, a_contactPoint_p);
+}
+
+bool
+GeometryEngine::SweepCircleRect(const CircleGeometry& a_circle,
+                                const SDL_FPoint& a_displacement,
+                                const SDL_FRect& a_rect,
+                                float& a_timeOfImpact,
+                                SDL_FPoint& a_normal) const
+{
+    return CollisionKernels::SweepCircleRect(a_circle, a_displacement, a_rect, a_timeOfImpact, a_normal);
+}
+
+int
+GeometryEngine::FindCircleRectHits(const CircleGeometry& a_circle,
+                                   const float* a_x_p,
+                                   const float* a_y_p,
+                                   const float* a_w_p,
+                                   const float* a_h_p,
+                                   const int a_count,
+                                   Uint32* a_hitMask_p) const
+{
+    // Same closest point test as GetClosestPointOnRect - a center inside the rect clamps to itself,
+    // which gives zero distance and counts as a hit.
+    const float radiusSquared = a_circle.radius * a_circle.radius;
+
+    for (int word = 0; word < (a_count + 31) / 32; word++)
+    {
+        a_hitMask_p[word] = 0;
+    }
+
+    int hitCount = 0;
+    int i = 0;
+
+#if defined(SDL_AVX_INTRINSICS)
+    const __m256 centerX8 = _mm256_set1_ps(a_circle.center.x);
+    const __m256 centerY8 = _mm256_set1_ps(a_circle.center.y);
+    const __m256 radiusSquared8 = _mm256_set1_ps(radiusSquared);
+    for (; i + 8 <= a_count; i += 8)
+    {
+        const __m256 rectX = _mm256_loadu_ps(a_x_p + i);
+        const __m256 rectY = _mm256_loadu_ps(a_y_p + i);
+        const __m256 closestX = _mm256_min_ps(_mm256_max_ps(centerX8, rectX), _mm256_add_ps(rectX, _mm256_loadu_ps(a_w_p + i)));
+        const __m256 closestY = _mm256_min_ps(_mm256_max_ps(centerY8, rectY), _mm256_add_ps(rectY, _mm256_loadu_ps(a_h_p + i)));
+        const __m256 distanceX = _mm256_sub_ps(centerX8, closestX);
+        const __m256 distanceY = _mm256_sub_ps(centerY8, closestY);
+        const __m256 distanceSquared = _mm256_add_ps(_mm256_mul_ps(distanceX, distanceX), _mm256_mul_ps(distanceY, distanceY));
+
+        const Uint32 hits = (Uint32)_mm256_movemask_ps(_mm256_cmp_ps(distanceSquared, radiusSquared8, _CMP_LT_OQ));
+        a_hitMask_p[i / 32] |= hits << (i % 32);
+        hitCount += countSetBits(hits);
+    }
+#endif
+
+#if defined(SDL_SSE_INTRINSICS)
+    const __m128 centerX4 = _mm_set1_ps(a_circle.center.x);
+    const __m128 centerY4 = _mm_set1_ps(a_circle.center.y);
+    const __m128 radiusSquared4 = _mm_set1_ps(radiusSquared);
+    for (; i + 4 <= a_count; i += 4)
+    {
+        const __m128 rectX = _mm_loadu_ps(a_x_p + i);
+        const __m128 rectY = _mm_loadu_ps(a_y_p + i);
+        const __m128 closestX = _mm_min_ps(_mm_max_ps(centerX4, rectX), _mm_add_ps(rectX, _mm_loadu_ps(a_w_p + i)));
+        const __m128 closestY = _mm_min_ps(_mm_max_ps(centerY4, rectY), _mm_add_ps(rectY, _mm_loadu_ps(a_h_p + i)));
+        const __m128 distanceX = _mm_sub_ps(centerX4, closestX);
+        const __m128 distanceY = _mm_sub_ps(centerY4, closestY);
+        const __m128 distanceSquared = _mm_add_ps(_mm_mul_ps(distanceX, distanceX), _mm_mul_ps(distanceY, distanceY));
+
+        const Uint32 hits = (Uint32)_mm_movemask_ps(_mm_cmplt_ps(distanceSquared, radiusSquared4));
+        a_hitMask_p[i / 32] |= hits << (i % 32);
+        hitCount += countSetBits(hits);
+    }
+#endif
+
+    // Scalar fallback, also handles the remainder of the vectorized loops
+    for (; i < a_count; i++)
+    {
+        const float closestX = SDL_min(SDL_max(a_circle.center.x, a_x_p[i]), a_x_p[i] + a_w_p[i]);
+        const float closestY = SDL_min(SDL_max(a_circle.center.y, a_y_p[i]), a_y_p[i] + a_h_p[i]);
+        const float distanceX = a_circle.center.x - closestX;
+        const float distanceY = a_circle.center.y - closestY;
+
+        if (distanceX * distanceX + distanceY * distanceY < radiusSquared)
+        {
+            a_hitMask_p[i / 32] |= 1u << (i % 32);
+            hitCount++;
+        }
+    }
+
+    return hitCount;
+}
+
+SDL_FPoint
+GeometryEngine::RotateVector(const SDL_FPoint a_vector, const float a_angleRad) const
+{
+    const float cosAngle = SDL_cosf(a_angleRad);
+    const float sinAngle = SDL_sinf(a_angleRad);
+
+    return {
+        a_vector.x * cosAngle + a_vector.y * sinAngle,
+        a_vector.x * sinAngle + a_vector.y * cosAngle,
+    };
+}
+
+SDL_FPoint
+GeometryEngine::GetClosestPointOnRect(const CircleGeometry &a_circle, const RectGeometry &a_rect, bool& a_isInsideRect) const
+{
+    return CollisionKernels::ClosestPointOnRect(a_circle.center, a_rect.rect, a_isInsideRect);
+}
@@ -1,21 +1,47 @@
-#pragma once
-
-struct CircleGeometry;
-struct RectGeometry;
-struct SDL_FPoint;
-
-class GeometryEngine
-{
-public:
-    virtual ~GeometryEngine() = default;
-
-    void SimulateMovement(CircleGeometry& a_circle, const float a_deltaSeconds) const;
-    void SimulateMovement(RectGeometry& a_rect, const float a_deltaSeconds) const;
-    
-    bool ProcessCollision(CircleGeometry& a_circle, RectGeometry& a_rect, SDL_FPoint* a_contactPoint_p) const;
-
-    SDL_FPoint RotateVector(const SDL_FPoint a_vector, const float a_angleRad) const;
-
-private:
-    SDL_FPoint getClosestPointOnRect(const CircleGeometry& a_circle, const RectGeometry& a_rect, bool& a_isInsideRect) const;
+#pragma once
+
+#include <SDL3/SDL.h>
+
+struct CircleGeometry;
+struct RectGeometry;
+
+class GeometryEngine
+{
+public:
+    virtual ~GeometryEngine() = default;
+
+    void SimulateMovement(CircleGeometry& a_circle, const float a_deltaSeconds) const;
+    void SimulateMovement(RectGeometry& a_rect, const float a_deltaSeconds) const;
+    
+    // Pick the response from the geometry properties at run time and forward to CollisionKernels. Code
+    // that knows what it collides calls the kernels directly instead.
+    bool ProcessCollision(CircleGeometry& a_circle, RectGeometry& a_rect, SDL_FPoint* a_contactPoint_p) const;
+    bool ProcessCollision(CircleGeometry& a_circle, CircleGeometry& a_otherCircle, SDL_FPoint* a_contactPoint_p) const;
+    bool ProcessCollision(RectGeometry& a_rect, RectGeometry& a_otherRect, SDL_FPoint* a_contactPoint_p) const;
+
+    // Continuous test of a circle moving by a_displacement against a static rect. On a hit returns the
+    // earliest time of impact as a fraction of the displacement and the surface normal at the contact.
+    // A circle that already overlaps the rect at the start is not reported - ProcessCollision resolves those.
+    bool SweepCircleRect(const CircleGeometry& a_circle,
+                         const SDL_FPoint& a_displacement,
+                         const SDL_FRect& a_rect,
+                         float& a_timeOfImpact,
+                         SDL_FPoint& a_normal) const;
+
+    // Overlap test of one circle against a batch of rects given as separate x/y/w/h arrays. Sets bit i
+    // of the mask (32 rects per word) when rect i overlaps the circle and returns the number of hits.
+    // Only the overlap is tested, the collision response is left to ProcessCollision.
+    int FindCircleRectHits(const CircleGeometry& a_circle,
+                           const float* a_x_p,
+                           const float* a_y_p,
+                           const float* a_w_p,
+                           const float* a_h_p,
+                           const int a_count,
+                           Uint32* a_hitMask_p) const;
+
+    SDL_FPoint RotateVector(const SDL_FPoint a_vector, const float a_angleRad) const;
+
+    // Point of the rect closest to the circle center. A center inside the rect gives the closest point on
+    // the rect edges instead and sets a_isInsideRect.
+    SDL_FPoint GetClosestPointOnRect(const CircleGeometry& a_circle, const RectGeometry& a_rect, bool& a_isInsideRect) const;
 };
\ No newline at end of file
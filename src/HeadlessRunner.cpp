@@ -0,0 +1,153 @@
+#include "HeadlessRunner.hpp"
+
+#include "GeometryEngine.hpp"
+#include "InputRecorder.hpp"
+#include "LevelController.hpp"
+#include "LevelFactory.hpp"
+#include "SimulationClock.hpp"
+
+namespace
+{
+
+const float AutopilotDeadZone = 10.0f; // Distance from the pad center within which the pad stops following the ball
+
+}
+
+HeadlessRunner::HeadlessRunner(std::shared_ptr<LevelFactory> a_levelFactory_sp,
+                               std::shared_ptr<GeometryEngine> a_geometryEngine_sp,
+                               const SDL_FRect& a_levelBounds)
+    : m_levelFactory_sp(a_levelFactory_sp)
+    , m_geometryEngine_sp(a_geometryEngine_sp)
+    , m_levelBounds(a_levelBounds)
+    , m_startLevelValid(false)
+    , m_levelController(a_geometryEngine_sp, Level())
+{
+}
+
+void
+HeadlessRunner::SetStressLevel(const StressLevelOptions& a_options)
+{
+    m_stressLevelOptions = a_options;
+    m_startLevelValid = false;
+}
+
+EpisodeResult
+HeadlessRunner::RunEpisode(const Uint64 a_seed,
+                           const Uint64 a_maxTicks,
+                           const Uint32 a_tickRateHz,
+                           const int a_extraBalls,
+                           InputRecorder* a_recorder_p)
+{
+    // Same fixed step the game uses, the clock itself is not needed as episodes run as fast as possible
+    const float tickSeconds = SimulationClock(a_tickRateHz, 1).TickSeconds();
+
+    if (!m_startLevelValid)
+    {
+        if (m_stressLevelOptions)
+        {
+            m_levelFactory_sp->CreateStressLevel(m_levelBounds, *m_stressLevelOptions, m_startLevel);
+        }
+        else
+        {
+            m_levelFactory_sp->CreateLevel(m_levelBounds, m_startLevel);
+        }
+        m_startLevelValid = true;
+    }
+
+    LevelController& levelController = m_levelController;
+    levelController.Reset(m_startLevel);
+    levelController.SetRandomSeed(a_seed);
+    levelController.SpawnBalls(a_extraBalls);
+    bool movingLeft = false;
+    bool movingRight = false;
+
+    if (a_recorder_p)
+    {
+        a_recorder_p->Begin(a_seed, m_levelBounds, a_tickRateHz, a_extraBalls);
+    }
+
+    EpisodeResult result;
+    while (!levelController.GameOver() && result.ticks < a_maxTicks)
+    {
+        applyScriptedInput(levelController, movingLeft, movingRight, a_recorder_p);
+        levelController.Iterate(tickSeconds);
+        result.narrowphaseTests += levelController.GetNarrowphaseTestCount();
+        result.ticks++;
+
+        if (a_recorder_p)
+        {
+            a_recorder_p->RecordTick(levelController.StateHash());
+        }
+    }
+
+    const Level& level = levelController.GetLevel();
+    result.score = level.score;
+    result.ballsLeft = level.balls;
+    result.levelCleared = levelController.GameOver() && level.balls >= 0;
+
+    return result;
+}
+
+void
+HeadlessRunner::applyScriptedInput(LevelController& a_levelController, bool& a_movingLeft, bool& a_movingRight, InputRecorder* a_recorder_p) const
+{
+    const Level& level = a_levelController.GetLevel();
+
+    // Follow the lowest ball that is falling, or the lowest one overall if none is
+    const Ball* trackedBall_p = nullptr;
+    bool trackedBallFalls = false;
+    bool hasBallOnPad = false;
+    for (const Ball& ball : level.ballsInPlay)
+    {
+        hasBallOnPad |= !ball.launched;
+
+        const bool ballFalls = ball.geometry.properties.velocity.has_value() && ball.geometry.properties.velocity->y > 0.0f;
+        if (!trackedBall_p ||
+            (ballFalls && !trackedBallFalls) ||
+            (ballFalls == trackedBallFalls && ball.geometry.center.y > trackedBall_p->geometry.center.y))
+        {
+            trackedBall_p = &ball;
+            trackedBallFalls = ballFalls;
+        }
+    }
+
+    if (hasBallOnPad)
+    {
+        sendKey(a_levelController, SDLK_SPACE, true, a_recorder_p);
+        sendKey(a_levelController, SDLK_SPACE, false, a_recorder_p);
+    }
+
+    const float padCenter = level.pad.geometry.rect.x + level.pad.geometry.rect.w / 2.0f;
+    const float targetX = trackedBall_p ? trackedBall_p->geometry.center.x : padCenter;
+    const bool moveLeft = targetX < padCenter - AutopilotDeadZone;
+    const bool moveRight = targetX > padCenter + AutopilotDeadZone;
+
+    // Only send key transitions, the same way a real keyboard would
+    if (moveLeft != a_movingLeft)
+    {
+        sendKey(a_levelController, SDLK_LEFT, moveLeft, a_recorder_p);
+        a_movingLeft = moveLeft;
+    }
+
+    if (moveRight != a_movingRight)
+    {
+        sendKey(a_levelController, SDLK_RIGHT, moveRight, a_recorder_p);
+        a_movingRight = moveRight;
+    }
+}
+
+void
+HeadlessRunner::sendKey(LevelController& a_levelController, const SDL_Keycode a_key, const bool a_isPressed, InputRecorder* a_recorder_p) const
+{
+    SDL_KeyboardEvent keyEvent;
+    SDL_zero(keyEvent);
+    keyEvent.type = a_isPressed ? SDL_EVENT_KEY_DOWN : SDL_EVENT_KEY_UP;
+    keyEvent.key = a_key;
+    keyEvent.down = a_isPressed;
+
+    if (a_recorder_p)
+    {
+        a_recorder_p->RecordKeyboardEvent(keyEvent);
+    }
+    a_levelController.HandleKeyboardEvent(keyEvent);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "LevelController.hpp"
+#include "LevelFactory.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <memory>
+#include <optional>
+
+class GeometryEngine;
+class InputRecorder;
+
+struct EpisodeResult
+{
+    Uint64 ticks = 0;
+    Uint64 narrowphaseTests = 0;
+    Uint32 score = 0;
+    int ballsLeft = 0;
+    bool levelCleared = false;
+};
+
+// Runs whole games without a window. Input comes from a scripted autopilot that
+// follows the ball with the pad and launches it whenever it rests on the pad. The start level is built
+// once and every episode resets the same LevelController from it, so episodes do not allocate.
+class HeadlessRunner
+{
+public:
+    explicit HeadlessRunner(std::shared_ptr<LevelFactory> a_levelFactory_sp,
+                            std::shared_ptr<GeometryEngine> a_geometryEngine_sp,
+                            const SDL_FRect& a_levelBounds);
+    virtual ~HeadlessRunner() = default;
+
+    // Plays a generated stress level instead of the built-in one in every following episode
+    void SetStressLevel(const StressLevelOptions& a_options);
+
+    // a_recorder_p is optional, when given the episode is recorded into it
+    EpisodeResult RunEpisode(const Uint64 a_seed,
+                             const Uint64 a_maxTicks,
+                             const Uint32 a_tickRateHz,
+                             const int a_extraBalls,
+                             InputRecorder* a_recorder_p);
+
+private:
+    void applyScriptedInput(LevelController& a_levelController, bool& a_movingLeft, bool& a_movingRight, InputRecorder* a_recorder_p) const;
+    void sendKey(LevelController& a_levelController, const SDL_Keycode a_key, const bool a_isPressed, InputRecorder* a_recorder_p) const;
+
+private:
+    std::shared_ptr<LevelFactory> m_levelFactory_sp;
+    std::shared_ptr<GeometryEngine> m_geometryEngine_sp;
+    SDL_FRect m_levelBounds;
+    std::optional<StressLevelOptions> m_stressLevelOptions;
+
+    Level m_startLevel;
+    bool m_startLevelValid;
+    LevelController m_levelController;
+};
@@ -0,0 +1,132 @@
+#include "HudTextCache.hpp"
+
+HudTextCache::HudTextCache()
+    : m_textureUpdates(0)
+{
+}
+
+bool
+HudTextCache::SetText(const HudLine a_line, const char* a_text)
+{
+    CachedLine& line = m_lines[(int)a_line];
+    if (SDL_strcmp(line.text, a_text) == 0)
+    {
+        return false;
+    }
+
+    SDL_strlcpy(line.text, a_text, sizeof(line.text));
+    line.length = (int)SDL_strlen(line.text);
+    line.textureValid = false;
+
+    return true;
+}
+
+const char*
+HudTextCache::Text(const HudLine a_line) const
+{
+    return m_lines[(int)a_line].text;
+}
+
+void
+HudTextCache::Render(SDL_Renderer* a_renderer_p,
+                     const HudLine a_line,
+                     const SDL_FPoint& a_position,
+                     const SDL_Color& a_color,
+                     const float a_pixelsPerUnit)
+{
+    CachedLine& line = m_lines[(int)a_line];
+    if (line.length == 0)
+    {
+        return;
+    }
+
+    const bool textureCurrent = line.textureValid &&
+                                line.pixelsPerUnit == a_pixelsPerUnit &&
+                                SDL_memcmp(&line.color, &a_color, sizeof(SDL_Color)) == 0;
+    if (!textureCurrent && !updateTexture(a_renderer_p, line, a_color, a_pixelsPerUnit))
+    {
+        // No render target, draw the glyphs directly
+        SDL_SetRenderDrawColor(a_renderer_p, a_color.r, a_color.g, a_color.b, a_color.a);
+        SDL_RenderDebugText(a_renderer_p, a_position.x, a_position.y, line.text);
+        return;
+    }
+
+    const float textW = (float)(line.length * SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE);
+    const float textH = (float)SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE;
+    const SDL_FRect sourceRect{0.0f, 0.0f, textW * line.pixelsPerUnit, textH * line.pixelsPerUnit};
+    const SDL_FRect destinationRect{a_position.x, a_position.y, textW, textH};
+    SDL_RenderTexture(a_renderer_p, line.texture_p, &sourceRect, &destinationRect);
+}
+
+void
+HudTextCache::Reset()
+{
+    for (CachedLine& line : m_lines)
+    {
+        if (line.texture_p)
+        {
+            SDL_DestroyTexture(line.texture_p);
+        }
+        line.texture_p = nullptr;
+        line.textureW = 0;
+        line.textureH = 0;
+        line.textureValid = false;
+    }
+}
+
+Uint64
+HudTextCache::TextureUpdateCount() const
+{
+    return m_textureUpdates;
+}
+
+bool
+HudTextCache::updateTexture(SDL_Renderer* a_renderer_p, CachedLine& a_line, const SDL_Color& a_color, const float a_pixelsPerUnit)
+{
+    // Rendered at window pixel resolution so the scaled glyphs stay as sharp as drawing them directly
+    const int textureW = (int)SDL_ceilf(a_line.length * SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE * a_pixelsPerUnit);
+    const int textureH = (int)SDL_ceilf(SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE * a_pixelsPerUnit);
+
+    // Lines are only ever recreated when they outgrow their texture, shorter text reuses it
+    if (!a_line.texture_p || textureW > a_line.textureW || textureH != a_line.textureH)
+    {
+        if (a_line.texture_p)
+        {
+            SDL_DestroyTexture(a_line.texture_p);
+        }
+
+        a_line.texture_p = SDL_CreateTexture(a_renderer_p, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, textureW, textureH);
+        if (!a_line.texture_p)
+        {
+            SDL_Log("Couldn't create HUD text texture: %s", SDL_GetError());
+            a_line.textureW = 0;
+            a_line.textureH = 0;
+            a_line.textureValid = false;
+            return false;
+        }
+
+        SDL_SetTextureBlendMode(a_line.texture_p, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureScaleMode(a_line.texture_p, SDL_SCALEMODE_NEAREST);
+        a_line.textureW = textureW;
+        a_line.textureH = textureH;
+    }
+
+    SDL_SetRenderTarget(a_renderer_p, a_line.texture_p);
+    SDL_SetRenderDrawBlendMode(a_renderer_p, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(a_renderer_p, 0, 0, 0, SDL_ALPHA_TRANSPARENT);
+    SDL_RenderClear(a_renderer_p);
+    SDL_SetRenderDrawBlendMode(a_renderer_p, SDL_BLENDMODE_BLEND);
+
+    SDL_SetRenderScale(a_renderer_p, a_pixelsPerUnit, a_pixelsPerUnit);
+    SDL_SetRenderDrawColor(a_renderer_p, a_color.r, a_color.g, a_color.b, a_color.a);
+    SDL_RenderDebugText(a_renderer_p, 0.0f, 0.0f, a_line.text);
+    SDL_SetRenderScale(a_renderer_p, 1.0f, 1.0f);
+    SDL_SetRenderTarget(a_renderer_p, nullptr);
+
+    a_line.color = a_color;
+    a_line.pixelsPerUnit = a_pixelsPerUnit;
+    a_line.textureValid = true;
+    m_textureUpdates++;
+
+    return true;
+}
\ No newline at end of file
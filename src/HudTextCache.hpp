@@ -0,0 +1,60 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+enum class HudLine
+{
+    Score,
+    Controls,
+    Paused,
+    Count
+};
+
+// HUD lines kept in fixed size buffers and pre-rendered with SDL_RenderDebugText into small target
+// textures, so an unchanged line costs one texture copy per frame. Setting or drawing a line never
+// allocates. The textures belong to the renderer they were created with, Reset releases them and has
+// to be called before that renderer is destroyed.
+class HudTextCache
+{
+public:
+    static const int MaxTextLength = 128;
+
+    HudTextCache();
+    virtual ~HudTextCache() = default;
+
+    // Returns false when the line already shows this text
+    bool SetText(const HudLine a_line, const char* a_text);
+    const char* Text(const HudLine a_line) const;
+
+    // Draws the line with its top left corner at a_position, a_pixelsPerUnit is the scale of the logical
+    // coordinates to window pixels the texture is rendered at
+    void Render(SDL_Renderer* a_renderer_p,
+                const HudLine a_line,
+                const SDL_FPoint& a_position,
+                const SDL_Color& a_color,
+                const float a_pixelsPerUnit);
+
+    void Reset();
+
+    // Number of times a line had to be rendered into its texture
+    Uint64 TextureUpdateCount() const;
+
+private:
+    struct CachedLine
+    {
+        char text[MaxTextLength] = {0};
+        int length = 0;
+        SDL_Texture* texture_p = nullptr;
+        int textureW = 0;
+        int textureH = 0;
+        SDL_Color color = {0, 0, 0, 0};
+        float pixelsPerUnit = 0.0f;
+        bool textureValid = false;
+    };
+
+    bool updateTexture(SDL_Renderer* a_renderer_p, CachedLine& a_line, const SDL_Color& a_color, const float a_pixelsPerUnit);
+
+private:
+    CachedLine m_lines[(int)HudLine::Count];
+    Uint64 m_textureUpdates;
+};
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "InputQueue.hpp"
+
+InputQueue::InputQueue()
+{
+    ResetLatencyStats();
+}
+
+bool
+InputQueue::Push(const TimedInput& a_input)
+{
+    return m_inputs.Push(a_input);
+}
+
+bool
+InputQueue::PopUntil(const Uint64 a_timeNS, const Uint64 a_frameSequence, TimedInput& a_input)
+{
+    const TimedInput* input_p = m_inputs.Front();
+    if (!input_p || input_p->event.common.timestamp > a_timeNS)
+    {
+        return false;
+    }
+
+    a_input = *input_p;
+    m_inputs.Pop();
+
+    // Without a present for a while the applied inputs pile up, the latency of the overflow is not measured
+    m_appliedInputs.Push({a_input.event.common.timestamp, a_frameSequence});
+    return true;
+}
+
+bool
+InputQueue::Empty()
+{
+    return m_inputs.Front() == nullptr;
+}
+
+void
+InputQueue::MarkPresented(const Uint64 a_presentNS, const Uint64 a_frameSequence)
+{
+    const AppliedInput* appliedInput_p = m_appliedInputs.Front();
+    while (appliedInput_p && appliedInput_p->frameSequence <= a_frameSequence)
+    {
+        const Uint64 timestampNS = appliedInput_p->timestampNS;
+        const Uint64 latencyNS = a_presentNS > timestampNS ? a_presentNS - timestampNS : 0;
+        m_latencySamples++;
+        m_latencySumNS += (double)latencyNS;
+        m_latencySquareSumNS += (double)latencyNS * (double)latencyNS;
+        m_maxLatencyNS = SDL_max(m_maxLatencyNS, latencyNS);
+
+        m_appliedInputs.Pop();
+        appliedInput_p = m_appliedInputs.Front();
+    }
+}
+
+InputLatencyStats
+InputQueue::GetLatencyStats() const
+{
+    InputLatencyStats stats;
+    stats.inputs = m_latencySamples;
+    if (m_latencySamples == 0)
+    {
+        return stats;
+    }
+
+    const double averageNS = m_latencySumNS / m_latencySamples;
+    const double varianceNS = SDL_max(m_latencySquareSumNS / m_latencySamples - averageNS * averageNS, 0.0);
+    stats.averageMS = averageNS / SDL_NS_PER_MS;
+    stats.jitterMS = SDL_sqrt(varianceNS) / SDL_NS_PER_MS;
+    stats.maxMS = (double)m_maxLatencyNS / SDL_NS_PER_MS;
+
+    return stats;
+}
+
+void
+InputQueue::ResetLatencyStats()
+{
+    m_latencySamples = 0;
+    m_latencySumNS = 0.0;
+    m_latencySquareSumNS = 0.0;
+    m_maxLatencyNS = 0;
+}
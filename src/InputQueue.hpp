@@ -0,0 +1,71 @@
+#pragma once
+
+#include "SpscQueue.hpp"
+
+#include <SDL3/SDL.h>
+
+enum class InputCommand
+{
+    LevelEvent,  // Key or mouse event for the level controller
+    Restart,     // Restarts the level, seeded with the event timestamp
+    Rewind       // Rewinds the level by Constants::RewindStepTicks
+};
+
+// Input waiting to be applied. Mouse positions are converted to level coordinates when the event
+// arrives, with the window layout of that moment.
+struct TimedInput
+{
+    InputCommand command = InputCommand::LevelEvent;
+    SDL_Event event;
+    SDL_FPoint levelPosition;
+};
+
+struct InputLatencyStats
+{
+    Uint64 inputs = 0;
+    double averageMS = 0.0;
+    double jitterMS = 0.0;  // Standard deviation of the latency
+    double maxMS = 0.0;
+};
+
+// Carries input from the main thread to the simulation thread. The simulation takes the events out at
+// the tick boundary that follows their SDL timestamp and sends back which published frame first shows
+// their effect. Once the main thread has presented that frame, the time from the timestamp to the
+// present is recorded as the input latency.
+class InputQueue
+{
+public:
+    static const Uint32 Capacity = 256;
+
+    InputQueue();
+    virtual ~InputQueue() = default;
+
+    // Main thread. Fails when the queue is full.
+    bool Push(const TimedInput& a_input);
+    // Main thread. Records the latency of every input applied up to the frame a_frameSequence.
+    void MarkPresented(const Uint64 a_presentNS, const Uint64 a_frameSequence);
+    InputLatencyStats GetLatencyStats() const;
+    void ResetLatencyStats();
+
+    // Simulation thread. Takes the oldest input out if it happened at or before a_timeNS, its effect
+    // shows first in the frame a_frameSequence.
+    bool PopUntil(const Uint64 a_timeNS, const Uint64 a_frameSequence, TimedInput& a_input);
+    // Simulation thread
+    bool Empty();
+
+private:
+    struct AppliedInput
+    {
+        Uint64 timestampNS;
+        Uint64 frameSequence;
+    };
+
+    SpscQueue<TimedInput, Capacity> m_inputs;
+    // Inputs that were applied but not presented yet, at most a queue full
+    SpscQueue<AppliedInput, Capacity> m_appliedInputs;
+
+    Uint64 m_latencySamples;
+    double m_latencySumNS;
+    double m_latencySquareSumNS;
+    Uint64 m_maxLatencyNS;
+};
@@ -0,0 +1,115 @@
+#include "InputRecorder.hpp"
+
+InputRecorder::InputRecorder()
+    : m_recording(false)
+{
+    SDL_zero(m_header);
+}
+
+void
+InputRecorder::Begin(const Uint64 a_randomSeed, const SDL_FRect& a_levelBounds, const Uint32 a_tickRateHz, const int a_extraBalls)
+{
+    SDL_zero(m_header);
+    m_header.magic = ReplayFormat::Magic;
+    m_header.version = ReplayFormat::Version;
+    m_header.headerSize = sizeof(ReplayHeader);
+    m_header.randomSeed = a_randomSeed;
+    m_header.levelBounds = a_levelBounds;
+    m_header.tickRateHz = a_tickRateHz;
+    m_header.extraBalls = (Uint32)SDL_max(a_extraBalls, 0);
+
+    m_events.clear();
+    m_stateHashes.clear();
+    m_recording = true;
+}
+
+bool
+InputRecorder::IsRecording() const
+{
+    return m_recording;
+}
+
+void
+InputRecorder::RecordKeyboardEvent(const SDL_KeyboardEvent& a_keyEvent)
+{
+    if (!m_recording)
+    {
+        return;
+    }
+
+    ReplayEvent event;
+    SDL_zero(event);
+    event.tick = (Uint32)m_stateHashes.size();
+    event.type = a_keyEvent.type == SDL_EVENT_KEY_DOWN ? ReplayFormat::EventType::KeyDown : ReplayFormat::EventType::KeyUp;
+    event.key = a_keyEvent.key;
+
+    m_events.push_back(event);
+}
+
+void
+InputRecorder::RecordMouseButtonEvent(const SDL_MouseButtonEvent& a_mouseButtonEvent, const SDL_FPoint a_levelMousePosition)
+{
+    if (!m_recording)
+    {
+        return;
+    }
+
+    ReplayEvent event;
+    SDL_zero(event);
+    event.tick = (Uint32)m_stateHashes.size();
+    event.type = a_mouseButtonEvent.type == SDL_EVENT_MOUSE_BUTTON_DOWN ? ReplayFormat::EventType::MouseButtonDown : ReplayFormat::EventType::MouseButtonUp;
+    event.mouseButton = a_mouseButtonEvent.button;
+    event.levelPosition = a_levelMousePosition;
+
+    m_events.push_back(event);
+}
+
+void
+InputRecorder::RecordTick(const Uint64 a_stateHash)
+{
+    if (m_recording)
+    {
+        m_stateHashes.push_back(a_stateHash);
+    }
+}
+
+bool
+InputRecorder::Save(const char* a_path)
+{
+    if (!m_recording)
+    {
+        return false;
+    }
+    m_recording = false;
+
+    // State hashes start on an 8 byte boundary so they can be read in place from a mapped file
+    const Uint64 eventsEnd = sizeof(ReplayHeader) + m_events.size() * sizeof(ReplayEvent);
+    const Uint64 padding = (8 - eventsEnd % 8) % 8;
+    const Uint8 zeros[8] = {0};
+
+    m_header.eventCount = (Uint32)m_events.size();
+    m_header.tickCount = m_stateHashes.size();
+    m_header.hashesOffset = eventsEnd + padding;
+
+    SDL_IOStream* stream_p = SDL_IOFromFile(a_path, "wb");
+    if (!stream_p)
+    {
+        SDL_Log("Couldn't open replay file %s for writing: %s", a_path, SDL_GetError());
+        return false;
+    }
+
+    const size_t eventBytes = m_events.size() * sizeof(ReplayEvent);
+    const size_t hashBytes = m_stateHashes.size() * sizeof(Uint64);
+    const bool written = SDL_WriteIO(stream_p, &m_header, sizeof(m_header)) == sizeof(m_header) &&
+                         SDL_WriteIO(stream_p, m_events.data(), eventBytes) == eventBytes &&
+                         SDL_WriteIO(stream_p, zeros, padding) == padding &&
+                         SDL_WriteIO(stream_p, m_stateHashes.data(), hashBytes) == hashBytes;
+
+    if (!SDL_CloseIO(stream_p) || !written)
+    {
+        SDL_Log("Couldn't write replay file %s: %s", a_path, SDL_GetError());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ReplayFormat.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <vector>
+
+// Collects the input applied to a LevelController, stamped with the simulation tick it was applied
+// before, together with the level state hash after every tick. Saved as a replay file.
+class InputRecorder
+{
+public:
+    InputRecorder();
+    virtual ~InputRecorder() = default;
+
+    void Begin(const Uint64 a_randomSeed, const SDL_FRect& a_levelBounds, const Uint32 a_tickRateHz, const int a_extraBalls = 0);
+    bool IsRecording() const;
+
+    void RecordKeyboardEvent(const SDL_KeyboardEvent& a_keyEvent);
+    void RecordMouseButtonEvent(const SDL_MouseButtonEvent& a_mouseButtonEvent, const SDL_FPoint a_levelMousePosition);
+    void RecordTick(const Uint64 a_stateHash);
+
+    // Writes the replay file and stops recording
+    bool Save(const char* a_path);
+
+private:
+    ReplayHeader m_header;
+    bool m_recording;
+
+    std::vector<ReplayEvent> m_events;
+    std::vector<Uint64> m_stateHashes;
+};
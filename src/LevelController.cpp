@@ -1,244 +1,842 @@
-#include "LevelController.hpp"
-
-#include "gameobjects/Brick.hpp"
-#include "GeometryEngine.hpp"
-
-namespace
-{
-
-const float MaxPadBounceAngle = 0.45f * SDL_PI_F; // Max angle for the ball to bounce off of the pad - less than 90 degrees
-
-}
-
-LevelController::LevelController(std::shared_ptr<GeometryEngine> a_geometryEngine_sp, const Level& a_level)
-    : m_geometryEngine_sp(a_geometryEngine_sp)
-    , m_level(a_level)
-    , m_gameOver(false)
-{
-}
-
-const Level&
-LevelController::GetLevel() const
-{
-    return m_level;
-}
-
-bool
-LevelController::GameOver() const
-{
-    return m_gameOver;
-}
-
-SDL_AppResult
-LevelController::Iterate(const float a_deltaTimeSec)
-{
-    if (m_level.paused || m_gameOver)
-    {
-        return SDL_APP_CONTINUE;
-    }
-
-    // Simulate movement
-    m_geometryEngine_sp->SimulateMovement(m_level.pad.geometry, a_deltaTimeSec);
-    m_level.pad.geometry.rect.x = SDL_clamp(m_level.pad.geometry.rect.x, m_level.bounds.x, m_level.bounds.x + m_level.bounds.w - m_level.pad.geometry.rect.w);
-    
-    if (m_level.ballLaunched)
-    {
-        m_geometryEngine_sp->SimulateMovement(m_level.ball.geometry, a_deltaTimeSec);
-    }
-    else
-    {
-        resetBall();
-    }
-
-    SDL_FPoint ballCenterMin{
-        m_level.bounds.x + m_level.ball.geometry.radius,
-        m_level.bounds.y + m_level.ball.geometry.radius
-    };
-    SDL_FPoint ballCenterMax{
-        ballCenterMin.x + m_level.bounds.w - m_level.ball.geometry.radius * 2.0f,
-        ballCenterMin.y + m_level.bounds.h
-    };
-
-    if (m_level.ball.geometry.center.x < ballCenterMin.x)
-    {
-        m_level.ball.geometry.center.x = ballCenterMin.x;
-        m_level.ball.geometry.properties.velocity->x *= -1.0f;
-    }
-    else if (m_level.ball.geometry.center.x > ballCenterMax.x)
-    {
-        m_level.ball.geometry.center.x = ballCenterMax.x;
-        m_level.ball.geometry.properties.velocity->x *= -1.0f;
-    }
-
-    if (m_level.ball.geometry.center.y < ballCenterMin.y)
-    {
-        m_level.ball.geometry.center.y = ballCenterMin.y;
-        m_level.ball.geometry.properties.velocity->y *= -1.0f;
-    }
-    else if (m_level.ball.geometry.center.y > ballCenterMax.y)
-    {
-        m_level.ballLaunched = false;
-        m_level.balls--;
-        resetBall();
-    }
-    
-    // Simulate collisions
-    bounceBallFromPad();
-
-    auto it = m_level.bricks.begin();
-    while (it != m_level.bricks.end())
-    {
-        if (m_geometryEngine_sp->ProcessCollision(m_level.ball.geometry, it->geometry, nullptr))
-        {
-            if (it->hitPoints > 0)
-            {
-                it->hitPoints--;
-            }
-
-            if (it->hitPoints == 0)
-            {
-                m_level.score += getBrickScore(*it);
-                it = m_level.bricks.erase(it);
-            }
-        }
-        else
-        {
-            ++it;
-        }
-    }
-
-    if (m_level.bricks.empty() || m_level.balls < 0)
-    {
-        m_gameOver = true;
-    }
-
-    return SDL_APP_CONTINUE;
-}
-
-SDL_AppResult
-LevelController::HandleKeyboardEvent(const SDL_KeyboardEvent& a_keyEvent)
-{
-    const bool isPressed = a_keyEvent.type == SDL_EVENT_KEY_DOWN;
-    switch (a_keyEvent.key)
-    {
-        case SDLK_LEFT:
-            updatePadMovement(isPressed, m_level.pad.movingRight);
-            break;
-
-        case SDLK_RIGHT:
-            updatePadMovement(m_level.pad.movingLeft, isPressed);
-            break;
-
-        case SDLK_SPACE:
-            if (isPressed && !m_level.paused && !m_level.ballLaunched)
-            {
-                launchBall();
-            }
-            break;
-
-        case SDLK_P:
-            if (isPressed)
-            {
-                m_level.paused = !m_level.paused;
-            }
-            break;
-    }
-
-    return SDL_APP_CONTINUE;
-}
-
-SDL_AppResult
-LevelController::HandleMouseMotionEvent(const SDL_MouseMotionEvent& a_mouseMotionEvent, const SDL_FPoint a_levelMousePosition)
-{
-    return SDL_APP_CONTINUE;
-}
-
-SDL_AppResult
-LevelController::HandleMouseButtonEvent(const SDL_MouseButtonEvent& a_mouseButtonEvent, const SDL_FPoint a_levelMousePosition)
-{
-    // Note: this is only for debug
-    if (a_mouseButtonEvent.type == SDL_EVENT_MOUSE_BUTTON_DOWN)
-    {
-        if (a_mouseButtonEvent.button == SDL_BUTTON_LEFT)
-        {
-            m_level.ball.geometry.center.x = a_levelMousePosition.x;
-            m_level.ball.geometry.center.y = a_levelMousePosition.y;
-        }
-        else if (a_mouseButtonEvent.button == SDL_BUTTON_RIGHT && m_level.ball.geometry.properties.velocity.has_value())
-        {
-            m_level.ball.geometry.properties.velocity->x = a_levelMousePosition.x - (m_level.ball.geometry.center.x);
-            m_level.ball.geometry.properties.velocity->y = a_levelMousePosition.y - (m_level.ball.geometry.center.y);
-        }
-    }
-
-    return SDL_APP_CONTINUE;
-}
-
-void
-LevelController::launchBall()
-{
-    resetBall();
-
-    const float randomAngleRad = (SDL_randf() * SDL_PI_F * 0.5f) - (SDL_PI_F / 4.0f);
-    m_level.ball.geometry.properties.velocity = m_geometryEngine_sp->RotateVector({0.0f, -Constants::StartingBallSpeed}, randomAngleRad);
-    m_level.ballLaunched = true;
-}
-
-void
-LevelController::resetBall()
-{
-    m_level.ball.geometry.center.x = m_level.pad.geometry.rect.x + (m_level.pad.geometry.rect.w / 2.0f);
-    m_level.ball.geometry.center.y = m_level.pad.geometry.rect.y - m_level.ball.geometry.radius;
-    m_level.ball.geometry.properties.velocity.reset();
-}
-
-void
-LevelController::updatePadMovement(const bool a_moveLeft, const bool a_moveRight)
-{
-    m_level.pad.movingLeft = a_moveLeft;
-    m_level.pad.movingRight = a_moveRight;
-
-    if (a_moveLeft == a_moveRight)
-    {
-        m_level.pad.geometry.properties.velocity.reset();
-    }
-    else
-    {
-        const float direction = a_moveLeft ? -1.0f : 1.0f;
-        m_level.pad.geometry.properties.velocity = SDL_FPoint{ direction * m_level.pad.speed, 0.0f };
-    }
-}
-
-void
-LevelController::bounceBallFromPad()
-{
-    SDL_FPoint padContactPoint;
-    if (m_geometryEngine_sp->ProcessCollision(m_level.ball.geometry, m_level.pad.geometry, &padContactPoint))
-    {
-        if (padContactPoint.y == m_level.pad.geometry.rect.y)
-        {
-            const float padPosition = (padContactPoint.x - m_level.pad.geometry.rect.x) / m_level.pad.geometry.rect.w;
-            const float angle = (-MaxPadBounceAngle * padPosition) + (MaxPadBounceAngle * (1.0f - padPosition));
-
-            m_level.ball.geometry.properties.velocity = m_geometryEngine_sp->RotateVector({0.0f, -Constants::StartingBallSpeed}, angle);
-        }
-    }
-}
-
-Uint32
-LevelController::getBrickScore(const Brick &a_brick)
-{
-    switch (a_brick.kind)
-    {
-    case BrickKind::HighScore:
-        return 300;
-
-    case BrickKind::NormalScore:
-        return 200;
-
-    case BrickKind::LowScore:
-        return 100;
-    }
-
-    return 0;
-}
+#include "LevelController.hpp"
+
+#include "CollisionKernels.hpp"
+#include "gameobjects/Brick.hpp"
+#include "gameobjects/LevelSnapshot.hpp"
+#include "GeometryEngine.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+
+const float MaxPadBounceAngle = 0.45f * SDL_PI_F; // Max angle for the ball to bounce off of the pad - less than 90 degrees
+const float MultiBallSpreadAngle = 0.25f * SDL_PI_F; // Angle between the balls spawned by the multi-ball power-up
+const int MaxBouncesPerTick = 8; // Limit of swept impacts resolved for one ball in one tick
+
+const Uint64 FnvOffsetBasis = 0xcbf29ce484222325ull;
+const Uint64 FnvPrime = 0x100000001b3ull;
+
+void
+hashBytes(Uint64& a_hash, const void* a_data_p, const size_t a_size)
+{
+    const Uint8* bytes_p = (const Uint8*)a_data_p;
+    for (size_t i = 0; i < a_size; i++)
+    {
+        a_hash = (a_hash ^ bytes_p[i]) * FnvPrime;
+    }
+}
+
+template <typename T>
+void
+hashValue(Uint64& a_hash, const T& a_value)
+{
+    hashBytes(a_hash, &a_value, sizeof(a_value));
+}
+
+}
+
+LevelController::LevelController(std::shared_ptr<GeometryEngine> a_geometryEngine_sp, const Level& a_level)
+    : m_geometryEngine_sp(a_geometryEngine_sp)
+    , m_level(a_level)
+    , m_gameOver(false)
+    , m_randomState(0)
+    , m_narrowphaseTests(0)
+{
+}
+
+void
+LevelController::Reset(const Level& a_level)
+{
+    // Caches of the brick layout compare revisions, they must not repeat one of the previous level
+    const Uint64 previousRevision = m_level.bricks.revision;
+    m_level = a_level;
+    m_level.bricks.revision = SDL_max(previousRevision, a_level.bricks.revision) + 1;
+
+    m_gameOver = false;
+    m_randomState = 0;
+    m_narrowphaseTests = 0;
+    m_hitBricks.clear();
+
+    // The scratch arrays keep their capacity, only the ball order carries over between ticks
+    m_previousBallCenters.clear();
+    m_pendingBallSpawns.clear();
+    m_ballOrder.clear();
+}
+
+const Level&
+LevelController::GetLevel() const
+{
+    return m_level;
+}
+
+bool
+LevelController::GameOver() const
+{
+    return m_gameOver;
+}
+
+void
+LevelController::SetRandomSeed(const Uint64 a_seed)
+{
+    m_randomState = a_seed;
+}
+
+Uint64
+LevelController::StateHash() const
+{
+    // FNV-1a over everything the simulation reads back in the next tick
+    Uint64 hash = FnvOffsetBasis;
+    hashValue(hash, m_level.pad.geometry.rect);
+    hashValue(hash, m_level.pad.geometry.properties.velocity.value_or(SDL_FPoint{0.0f, 0.0f}));
+
+    for (const Ball& ball : m_level.ballsInPlay)
+    {
+        hashValue(hash, ball.geometry.center);
+        hashValue(hash, ball.geometry.radius);
+        hashValue(hash, ball.geometry.properties.velocity.value_or(SDL_FPoint{0.0f, 0.0f}));
+        hashValue(hash, ball.launched);
+    }
+
+    hashBytes(hash, m_level.bricks.hitPoints.data(), m_level.bricks.hitPoints.size() * sizeof(int));
+    hashBytes(hash, m_level.bricks.alive.data(), m_level.bricks.alive.size());
+
+    hashValue(hash, m_level.score);
+    hashValue(hash, m_level.balls);
+    hashValue(hash, m_level.paused);
+    hashValue(hash, m_gameOver);
+    hashValue(hash, m_randomState);
+
+    return hash;
+}
+
+Uint32
+LevelController::GetNarrowphaseTestCount() const
+{
+    return m_narrowphaseTests;
+}
+
+const std::vector<Uint32>&
+LevelController::GetHitBricks() const
+{
+    return m_hitBricks;
+}
+
+bool
+LevelController::Snapshot(LevelSnapshot& a_snapshot) const
+{
+    const BrickStore& bricks = m_level.bricks;
+    if (m_level.ballsInPlay.size() > LevelSnapshot::MaxBalls || bricks.Size() > LevelSnapshot::MaxBricks)
+    {
+        return false;
+    }
+
+    const RectGeometry& pad = m_level.pad.geometry;
+    a_snapshot.padRect = pad.rect;
+    a_snapshot.padVelocity = pad.properties.velocity.value_or(SDL_FPoint{0.0f, 0.0f});
+    a_snapshot.padSpeed = m_level.pad.speed;
+    a_snapshot.padHasVelocity = pad.properties.velocity.has_value();
+    a_snapshot.padMovingLeft = m_level.pad.movingLeft;
+    a_snapshot.padMovingRight = m_level.pad.movingRight;
+
+    a_snapshot.paused = m_level.paused;
+    a_snapshot.gameOver = m_gameOver;
+    a_snapshot.balls = m_level.balls;
+    a_snapshot.score = m_level.score;
+    a_snapshot.randomState = m_randomState;
+
+    a_snapshot.ballCount = (Uint32)m_level.ballsInPlay.size();
+    for (Uint32 i = 0; i < a_snapshot.ballCount; i++)
+    {
+        const Ball& ball = m_level.ballsInPlay[i];
+        BallSnapshot& ballSnapshot = a_snapshot.ballsInPlay[i];
+        ballSnapshot.center = ball.geometry.center;
+        ballSnapshot.velocity = ball.geometry.properties.velocity.value_or(SDL_FPoint{0.0f, 0.0f});
+        ballSnapshot.radius = ball.geometry.radius;
+        ballSnapshot.hasVelocity = ball.geometry.properties.velocity.has_value();
+        ballSnapshot.launched = ball.launched;
+    }
+
+    // The order only ever holds as many entries as there are balls, so it fits as well
+    a_snapshot.ballOrderCount = (Uint32)SDL_min(m_ballOrder.size(), (size_t)LevelSnapshot::MaxBalls);
+    for (Uint32 i = 0; i < a_snapshot.ballOrderCount; i++)
+    {
+        a_snapshot.ballOrder[i] = (Uint8)m_ballOrder[i];
+    }
+
+    a_snapshot.brickCount = (Uint32)bricks.Size();
+    a_snapshot.brickAliveCount = (Uint32)bricks.aliveCount;
+    SDL_memcpy(a_snapshot.brickAlive, bricks.alive.data(), bricks.Size());
+    // Bricks start with a single hit point and only lose them, a byte is plenty
+    const int* hitPoints_p = bricks.hitPoints.data();
+    for (size_t i = 0; i < bricks.Size(); i++)
+    {
+        a_snapshot.brickHitPoints[i] = (Uint8)hitPoints_p[i];
+    }
+
+    return true;
+}
+
+bool
+LevelController::Restore(const LevelSnapshot& a_snapshot)
+{
+    BrickStore& bricks = m_level.bricks;
+    if (a_snapshot.brickCount != bricks.Size() || a_snapshot.ballCount > LevelSnapshot::MaxBalls)
+    {
+        return false;
+    }
+
+    RectGeometry& pad = m_level.pad.geometry;
+    pad.rect = a_snapshot.padRect;
+    if (a_snapshot.padHasVelocity)
+    {
+        pad.properties.velocity = a_snapshot.padVelocity;
+    }
+    else
+    {
+        pad.properties.velocity.reset();
+    }
+    m_level.pad.speed = a_snapshot.padSpeed;
+    m_level.pad.movingLeft = a_snapshot.padMovingLeft != 0;
+    m_level.pad.movingRight = a_snapshot.padMovingRight != 0;
+
+    m_level.paused = a_snapshot.paused != 0;
+    m_gameOver = a_snapshot.gameOver != 0;
+    m_level.balls = a_snapshot.balls;
+    m_level.score = a_snapshot.score;
+    m_randomState = a_snapshot.randomState;
+
+    m_level.ballsInPlay.resize(a_snapshot.ballCount);
+    for (Uint32 i = 0; i < a_snapshot.ballCount; i++)
+    {
+        const BallSnapshot& ballSnapshot = a_snapshot.ballsInPlay[i];
+        Ball& ball = m_level.ballsInPlay[i];
+        ball.geometry.properties.isSolid = true;
+        ball.geometry.properties.isVisible = true;
+        ball.geometry.center = ballSnapshot.center;
+        ball.geometry.radius = ballSnapshot.radius;
+        if (ballSnapshot.hasVelocity)
+        {
+            ball.geometry.properties.velocity = ballSnapshot.velocity;
+        }
+        else
+        {
+            ball.geometry.properties.velocity.reset();
+        }
+        ball.launched = ballSnapshot.launched != 0;
+    }
+
+    m_ballOrder.assign(a_snapshot.ballOrder, a_snapshot.ballOrder + a_snapshot.ballOrderCount);
+    m_pendingBallSpawns.clear();
+    m_hitBricks.clear();
+
+    int* hitPoints_p = bricks.hitPoints.data();
+    for (Uint32 i = 0; i < a_snapshot.brickCount; i++)
+    {
+        hitPoints_p[i] = a_snapshot.brickHitPoints[i];
+    }
+
+    // Only the bricks whose state differs touch the grid, the brick layer caches see a new revision
+    if (SDL_memcmp(bricks.alive.data(), a_snapshot.brickAlive, a_snapshot.brickCount) != 0)
+    {
+        for (Uint32 i = 0; i < a_snapshot.brickCount; i++)
+        {
+            if (bricks.alive[i] == a_snapshot.brickAlive[i])
+            {
+                continue;
+            }
+
+            if (a_snapshot.brickAlive[i])
+            {
+                m_level.brickGrid.Insert(i, bricks.Rect(i));
+            }
+            else
+            {
+                m_level.brickGrid.Remove(i, bricks.Rect(i));
+            }
+            bricks.alive[i] = a_snapshot.brickAlive[i];
+        }
+        bricks.revision++;
+    }
+    bricks.aliveCount = a_snapshot.brickAliveCount;
+
+    return true;
+}
+
+SDL_AppResult
+LevelController::Iterate(const float a_deltaTimeSec)
+{
+    ARKANOID_PROFILE_SCOPE(ProfilePhase::LevelIterate);
+    m_narrowphaseTests = 0;
+    m_hitBricks.clear();
+
+    if (m_level.paused || m_gameOver)
+    {
+        return SDL_APP_CONTINUE;
+    }
+
+    std::vector<Ball>& ballsInPlay = m_level.ballsInPlay;
+
+    // Simulate movement
+    {
+        ARKANOID_PROFILE_SCOPE(ProfilePhase::BallMovement);
+        m_geometryEngine_sp->SimulateMovement(m_level.pad.geometry, a_deltaTimeSec);
+        m_level.pad.geometry.rect.x = SDL_clamp(m_level.pad.geometry.rect.x, m_level.bounds.x, m_level.bounds.x + m_level.bounds.w - m_level.pad.geometry.rect.w);
+
+        m_previousBallCenters.resize(ballsInPlay.size());
+        for (size_t i = 0; i < ballsInPlay.size(); i++)
+        {
+            m_previousBallCenters[i] = ballsInPlay[i].geometry.center;
+            if (ballsInPlay[i].launched)
+            {
+                moveBallThroughBricks(ballsInPlay[i], a_deltaTimeSec);
+            }
+            else
+            {
+                placeBallOnPad(ballsInPlay[i]);
+            }
+        }
+    }
+
+    // Balls that fell out of the level are dropped, a life is only lost with the last one
+    size_t ballIndex = 0;
+    while (ballIndex < ballsInPlay.size())
+    {
+        if (keepBallInBounds(ballsInPlay[ballIndex]))
+        {
+            ballIndex++;
+            continue;
+        }
+
+        ballsInPlay[ballIndex] = ballsInPlay.back();
+        ballsInPlay.pop_back();
+        m_previousBallCenters[ballIndex] = m_previousBallCenters.back();
+        m_previousBallCenters.pop_back();
+    }
+
+    if (ballsInPlay.empty())
+    {
+        m_level.balls--;
+        addBallOnPad();
+        m_previousBallCenters.push_back(ballsInPlay.back().geometry.center);
+    }
+
+    // Simulate collisions
+    {
+        ARKANOID_PROFILE_SCOPE(ProfilePhase::BrickCollision);
+        for (size_t i = 0; i < ballsInPlay.size(); i++)
+        {
+            bounceBallFromPad(ballsInPlay[i]);
+            collideBallWithBricks(ballsInPlay[i], m_previousBallCenters[i]);
+        }
+    }
+
+    {
+        ARKANOID_PROFILE_SCOPE(ProfilePhase::BallCollision);
+        spawnPendingBalls();
+        collideBalls();
+    }
+
+    if (m_level.bricks.Empty() || m_level.balls < 0)
+    {
+        m_gameOver = true;
+    }
+
+    return SDL_APP_CONTINUE;
+}
+
+SDL_AppResult
+LevelController::HandleKeyboardEvent(const SDL_KeyboardEvent& a_keyEvent)
+{
+    const bool isPressed = a_keyEvent.type == SDL_EVENT_KEY_DOWN;
+    switch (a_keyEvent.key)
+    {
+        case SDLK_LEFT:
+            updatePadMovement(isPressed, m_level.pad.movingRight);
+            break;
+
+        case SDLK_RIGHT:
+            updatePadMovement(m_level.pad.movingLeft, isPressed);
+            break;
+
+        case SDLK_SPACE:
+            if (isPressed && !m_level.paused)
+            {
+                launchBalls();
+            }
+            break;
+
+        case SDLK_P:
+            if (isPressed)
+            {
+                m_level.paused = !m_level.paused;
+            }
+            break;
+    }
+
+    return SDL_APP_CONTINUE;
+}
+
+SDL_AppResult
+LevelController::HandleMouseMotionEvent(const SDL_MouseMotionEvent& a_mouseMotionEvent, const SDL_FPoint a_levelMousePosition)
+{
+    return SDL_APP_CONTINUE;
+}
+
+SDL_AppResult
+LevelController::HandleMouseButtonEvent(const SDL_MouseButtonEvent& a_mouseButtonEvent, const SDL_FPoint a_levelMousePosition)
+{
+    // Note: this is only for debug
+    if (a_mouseButtonEvent.type == SDL_EVENT_MOUSE_BUTTON_DOWN && !m_level.ballsInPlay.empty())
+    {
+        CircleGeometry& ballGeometry = m_level.ballsInPlay.front().geometry;
+        if (a_mouseButtonEvent.button == SDL_BUTTON_LEFT)
+        {
+            ballGeometry.center.x = a_levelMousePosition.x;
+            ballGeometry.center.y = a_levelMousePosition.y;
+        }
+        else if (a_mouseButtonEvent.button == SDL_BUTTON_RIGHT && ballGeometry.properties.velocity.has_value())
+        {
+            ballGeometry.properties.velocity->x = a_levelMousePosition.x - (ballGeometry.center.x);
+            ballGeometry.properties.velocity->y = a_levelMousePosition.y - (ballGeometry.center.y);
+        }
+    }
+
+    return SDL_APP_CONTINUE;
+}
+
+void
+LevelController::launchBalls()
+{
+    for (Ball& ball : m_level.ballsInPlay)
+    {
+        if (ball.launched)
+        {
+            continue;
+        }
+
+        placeBallOnPad(ball);
+
+        const float randomAngleRad = (SDL_randf_r(&m_randomState) * SDL_PI_F * 0.5f) - (SDL_PI_F / 4.0f);
+        ball.geometry.properties.velocity = m_geometryEngine_sp->RotateVector({0.0f, -Constants::StartingBallSpeed}, randomAngleRad);
+        ball.launched = true;
+    }
+}
+
+void
+LevelController::placeBallOnPad(Ball& a_ball)
+{
+    a_ball.geometry.center.x = m_level.pad.geometry.rect.x + (m_level.pad.geometry.rect.w / 2.0f);
+    a_ball.geometry.center.y = m_level.pad.geometry.rect.y - a_ball.geometry.radius;
+    a_ball.geometry.properties.velocity.reset();
+    a_ball.launched = false;
+}
+
+void
+LevelController::addBallOnPad()
+{
+    Ball ball;
+    ball.geometry.properties.isSolid = true;
+    ball.geometry.properties.isVisible = true;
+    ball.geometry.radius = Constants::StartingBallSize / 2.0f;
+    placeBallOnPad(ball);
+
+    m_level.ballsInPlay.push_back(ball);
+}
+
+void
+LevelController::SpawnBalls(const int a_count)
+{
+    for (int i = 0; i < a_count && m_level.ballsInPlay.size() < Constants::MaxBallsInPlay; i++)
+    {
+        addBallOnPad();
+
+        Ball& ball = m_level.ballsInPlay.back();
+        const float randomAngleRad = (SDL_randf_r(&m_randomState) * SDL_PI_F * 0.5f) - (SDL_PI_F / 4.0f);
+        ball.geometry.properties.velocity = m_geometryEngine_sp->RotateVector({0.0f, -Constants::StartingBallSpeed}, randomAngleRad);
+        ball.launched = true;
+    }
+}
+
+bool
+LevelController::keepBallInBounds(Ball& a_ball)
+{
+    if (!a_ball.launched)
+    {
+        return true;
+    }
+
+    CircleGeometry& ballGeometry = a_ball.geometry;
+    SDL_FPoint ballCenterMin{
+        m_level.bounds.x + ballGeometry.radius,
+        m_level.bounds.y + ballGeometry.radius
+    };
+    SDL_FPoint ballCenterMax{
+        ballCenterMin.x + m_level.bounds.w - ballGeometry.radius * 2.0f,
+        ballCenterMin.y + m_level.bounds.h
+    };
+
+    if (ballGeometry.center.x < ballCenterMin.x)
+    {
+        ballGeometry.center.x = ballCenterMin.x;
+        ballGeometry.properties.velocity->x *= -1.0f;
+    }
+    else if (ballGeometry.center.x > ballCenterMax.x)
+    {
+        ballGeometry.center.x = ballCenterMax.x;
+        ballGeometry.properties.velocity->x *= -1.0f;
+    }
+
+    if (ballGeometry.center.y < ballCenterMin.y)
+    {
+        ballGeometry.center.y = ballCenterMin.y;
+        ballGeometry.properties.velocity->y *= -1.0f;
+    }
+    else if (ballGeometry.center.y > ballCenterMax.y)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void
+LevelController::updatePadMovement(const bool a_moveLeft, const bool a_moveRight)
+{
+    m_level.pad.movingLeft = a_moveLeft;
+    m_level.pad.movingRight = a_moveRight;
+
+    if (a_moveLeft == a_moveRight)
+    {
+        m_level.pad.geometry.properties.velocity.reset();
+    }
+    else
+    {
+        const float direction = a_moveLeft ? -1.0f : 1.0f;
+        m_level.pad.geometry.properties.velocity = SDL_FPoint{ direction * m_level.pad.speed, 0.0f };
+    }
+}
+
+void
+LevelController::bounceBallFromPad(Ball& a_ball)
+{
+    // A ball waiting on the pad has no velocity yet, it only reports the contact
+    SDL_FPoint padContactPoint;
+    const bool padContact = a_ball.geometry.properties.velocity.has_value()
+        ? CollisionKernels::CircleRect<MovingSolidBody, StaticSolidBody>(a_ball.geometry, m_level.pad.geometry.rect, &padContactPoint)
+        : CollisionKernels::CircleRect<StaticSolidBody, StaticSolidBody>(a_ball.geometry, m_level.pad.geometry.rect, &padContactPoint);
+    if (padContact)
+    {
+        if (padContactPoint.y == m_level.pad.geometry.rect.y)
+        {
+            a_ball.geometry.properties.velocity = getPadBounceVelocity(padContactPoint.x);
+        }
+    }
+}
+
+SDL_FPoint
+LevelController::getPadBounceVelocity(const float a_contactX) const
+{
+    const float padPosition = (a_contactX - m_level.pad.geometry.rect.x) / m_level.pad.geometry.rect.w;
+    const float angle = (-MaxPadBounceAngle * padPosition) + (MaxPadBounceAngle * (1.0f - padPosition));
+
+    return m_geometryEngine_sp->RotateVector({0.0f, -Constants::StartingBallSpeed}, angle);
+}
+
+void
+LevelController::collideBallWithBricks(Ball& a_ball, const SDL_FPoint& a_previousBallCenter)
+{
+    // Only bricks in the grid cells touched by the ball during this tick can collide with it
+    CircleGeometry& ballGeometry = a_ball.geometry;
+    const SDL_FRect sweptBallBounds{
+        SDL_min(a_previousBallCenter.x, ballGeometry.center.x) - ballGeometry.radius,
+        SDL_min(a_previousBallCenter.y, ballGeometry.center.y) - ballGeometry.radius,
+        SDL_abs(ballGeometry.center.x - a_previousBallCenter.x) + ballGeometry.radius * 2.0f,
+        SDL_abs(ballGeometry.center.y - a_previousBallCenter.y) + ballGeometry.radius * 2.0f
+    };
+    m_level.brickGrid.Query(sweptBallBounds, m_brickCandidates);
+
+    const int candidateCount = (int)m_brickCandidates.size();
+    if (candidateCount == 0)
+    {
+        return;
+    }
+
+    // Gather the candidate rects so the overlap test can run over them in SIMD batches
+    BrickStore& bricks = m_level.bricks;
+    m_candidateX.resize(candidateCount);
+    m_candidateY.resize(candidateCount);
+    m_candidateW.resize(candidateCount);
+    m_candidateH.resize(candidateCount);
+    m_candidateHitMask.resize((candidateCount + 31) / 32);
+    for (int i = 0; i < candidateCount; i++)
+    {
+        const Uint32 brickIndex = m_brickCandidates[i];
+        m_candidateX[i] = bricks.x[brickIndex];
+        m_candidateY[i] = bricks.y[brickIndex];
+        m_candidateW[i] = bricks.w[brickIndex];
+        m_candidateH[i] = bricks.h[brickIndex];
+    }
+
+    m_narrowphaseTests += candidateCount;
+    const int hitCount = m_geometryEngine_sp->FindCircleRectHits(ballGeometry,
+                                                                 m_candidateX.data(),
+                                                                 m_candidateY.data(),
+                                                                 m_candidateW.data(),
+                                                                 m_candidateH.data(),
+                                                                 candidateCount,
+                                                                 m_candidateHitMask.data());
+    if (hitCount == 0)
+    {
+        return;
+    }
+
+    // Only overlapping bricks go through the full collision response. Bricks are always solid and static,
+    // the ball picks the kernel once for all of them.
+    if (ballGeometry.properties.velocity.has_value())
+    {
+        resolveBrickHits<MovingSolidBody>(ballGeometry, candidateCount);
+    }
+    else
+    {
+        resolveBrickHits<StaticSolidBody>(ballGeometry, candidateCount);
+    }
+}
+
+template <typename TBall>
+void
+LevelController::resolveBrickHits(CircleGeometry& a_ballGeometry, const int a_candidateCount)
+{
+    const BrickStore& bricks = m_level.bricks;
+    for (int i = 0; i < a_candidateCount; i++)
+    {
+        if ((m_candidateHitMask[i / 32] & (1u << (i % 32))) == 0)
+        {
+            continue;
+        }
+
+        const Uint32 brickIndex = m_brickCandidates[i];
+        if (CollisionKernels::CircleRect<TBall, StaticSolidBody>(a_ballGeometry, bricks.Rect(brickIndex), nullptr))
+        {
+            hitBrick(brickIndex, a_ballGeometry.center);
+        }
+    }
+}
+
+void
+LevelController::moveBallThroughBricks(Ball& a_ball, const float a_deltaTimeSec)
+{
+    // Continuous collision against the bricks and the pad: the ball moves to the earliest impact along
+    // its path, bounces off and continues with the rest of the movement, so it cannot tunnel at any speed
+    CircleGeometry& ballGeometry = a_ball.geometry;
+    SDL_FPoint& velocity = ballGeometry.properties.velocity.value();
+    float remainingTime = a_deltaTimeSec;
+
+    for (int bounce = 0; bounce <= MaxBouncesPerTick; bounce++)
+    {
+        const SDL_FPoint displacement{velocity.x * remainingTime, velocity.y * remainingTime};
+        if (bounce == MaxBouncesPerTick)
+        {
+            // Out of bounces, the discrete pass resolves whatever is left
+            ballGeometry.center.x += displacement.x;
+            ballGeometry.center.y += displacement.y;
+            break;
+        }
+
+        const SDL_FRect sweptBallBounds{
+            SDL_min(ballGeometry.center.x, ballGeometry.center.x + displacement.x) - ballGeometry.radius,
+            SDL_min(ballGeometry.center.y, ballGeometry.center.y + displacement.y) - ballGeometry.radius,
+            SDL_abs(displacement.x) + ballGeometry.radius * 2.0f,
+            SDL_abs(displacement.y) + ballGeometry.radius * 2.0f
+        };
+        m_level.brickGrid.Query(sweptBallBounds, m_brickCandidates);
+
+        float earliestImpact = 1.0f;
+        SDL_FPoint impactNormal{0.0f, 0.0f};
+        Uint32 impactBrick = 0;
+        bool hasImpact = false;
+        bool padImpact = false;
+
+        float timeOfImpact;
+        SDL_FPoint normal;
+        if (CollisionKernels::SweepCircleRect(ballGeometry, displacement, m_level.pad.geometry.rect, timeOfImpact, normal))
+        {
+            earliestImpact = timeOfImpact;
+            impactNormal = normal;
+            padImpact = true;
+        }
+
+        for (const Uint32 brickIndex : m_brickCandidates)
+        {
+            m_narrowphaseTests++;
+            if (CollisionKernels::SweepCircleRect(ballGeometry, displacement, m_level.bricks.Rect(brickIndex), timeOfImpact, normal) &&
+                timeOfImpact <= earliestImpact)
+            {
+                earliestImpact = timeOfImpact;
+                impactNormal = normal;
+                impactBrick = brickIndex;
+                hasImpact = true;
+                padImpact = false;
+            }
+        }
+
+        if (!hasImpact && !padImpact)
+        {
+            ballGeometry.center.x += displacement.x;
+            ballGeometry.center.y += displacement.y;
+            break;
+        }
+
+        ballGeometry.center.x += displacement.x * earliestImpact;
+        ballGeometry.center.y += displacement.y * earliestImpact;
+
+        if (padImpact && impactNormal.y < 0.0f && impactNormal.x == 0.0f)
+        {
+            // Top of the pad aims the ball depending on where it landed
+            velocity = getPadBounceVelocity(ballGeometry.center.x);
+        }
+        else
+        {
+            const float velocityDotNormal = velocity.x * impactNormal.x + velocity.y * impactNormal.y;
+            velocity.x -= 2.0f * velocityDotNormal * impactNormal.x;
+            velocity.y -= 2.0f * velocityDotNormal * impactNormal.y;
+        }
+
+        if (!padImpact)
+        {
+            hitBrick(impactBrick, ballGeometry.center);
+        }
+        remainingTime *= 1.0f - earliestImpact;
+    }
+}
+
+void
+LevelController::hitBrick(const Uint32 a_brickIndex, const SDL_FPoint& a_ballCenter)
+{
+    BrickStore& bricks = m_level.bricks;
+    m_hitBricks.push_back(a_brickIndex);
+    if (bricks.hitPoints[a_brickIndex] > 0)
+    {
+        bricks.hitPoints[a_brickIndex]--;
+    }
+
+    if (bricks.hitPoints[a_brickIndex] == 0)
+    {
+        m_level.score += getBrickScore(bricks.kind[a_brickIndex]);
+        m_level.brickGrid.Remove(a_brickIndex, bricks.Rect(a_brickIndex));
+        bricks.Remove(a_brickIndex);
+
+        if (bricks.kind[a_brickIndex] == BrickKind::MultiBall)
+        {
+            m_pendingBallSpawns.push_back(a_ballCenter);
+        }
+    }
+}
+
+void
+LevelController::spawnPendingBalls()
+{
+    // Balls are spawned after the collision pass so the ball container does not change while iterating it
+    for (const SDL_FPoint& spawnPosition : m_pendingBallSpawns)
+    {
+        for (int i = 0; i < Constants::MultiBallSpawnCount && m_level.ballsInPlay.size() < Constants::MaxBallsInPlay; i++)
+        {
+            addBallOnPad();
+
+            Ball& ball = m_level.ballsInPlay.back();
+            const float angle = MultiBallSpreadAngle * (i - (Constants::MultiBallSpawnCount - 1) / 2.0f);
+            ball.geometry.center = spawnPosition;
+            ball.geometry.properties.velocity = m_geometryEngine_sp->RotateVector({0.0f, Constants::StartingBallSpeed}, angle);
+            ball.launched = true;
+        }
+    }
+
+    m_pendingBallSpawns.clear();
+}
+
+void
+LevelController::collideBalls()
+{
+    std::vector<Ball>& ballsInPlay = m_level.ballsInPlay;
+    if (ballsInPlay.size() < 2)
+    {
+        return;
+    }
+
+    // Sweep and prune along the x axis. The order from the previous tick is almost sorted already,
+    // so insertion sort keeps it up to date in close to linear time.
+    if (m_ballOrder.size() != ballsInPlay.size())
+    {
+        m_ballOrder.resize(ballsInPlay.size());
+        for (Uint32 i = 0; i < m_ballOrder.size(); i++)
+        {
+            m_ballOrder[i] = i;
+        }
+    }
+
+    for (size_t i = 1; i < m_ballOrder.size(); i++)
+    {
+        const Uint32 ballIndex = m_ballOrder[i];
+        const float minX = ballsInPlay[ballIndex].geometry.center.x - ballsInPlay[ballIndex].geometry.radius;
+
+        size_t j = i;
+        while (j > 0)
+        {
+            const CircleGeometry& previous = ballsInPlay[m_ballOrder[j - 1]].geometry;
+            if (previous.center.x - previous.radius <= minX)
+            {
+                break;
+            }
+
+            m_ballOrder[j] = m_ballOrder[j - 1];
+            j--;
+        }
+        m_ballOrder[j] = ballIndex;
+    }
+
+    for (size_t i = 0; i < m_ballOrder.size(); i++)
+    {
+        Ball& ball = ballsInPlay[m_ballOrder[i]];
+        if (!ball.launched)
+        {
+            continue;
+        }
+
+        const float maxX = ball.geometry.center.x + ball.geometry.radius;
+        for (size_t j = i + 1; j < m_ballOrder.size(); j++)
+        {
+            Ball& other = ballsInPlay[m_ballOrder[j]];
+            if (other.geometry.center.x - other.geometry.radius > maxX)
+            {
+                break;
+            }
+
+            if (!other.launched || SDL_abs(other.geometry.center.y - ball.geometry.center.y) > ball.geometry.radius + other.geometry.radius)
+            {
+                continue;
+            }
+
+            // Launched balls always have a velocity
+            m_narrowphaseTests++;
+            CollisionKernels::CircleCircle<MovingSolidBody, MovingSolidBody>(ball.geometry, other.geometry, nullptr);
+        }
+    }
+}
+
+Uint32
+LevelController::getBrickScore(const BrickKind a_brickKind)
+{
+    switch (a_brickKind)
+    {
+    case BrickKind::HighScore:
+        return 300;
+
+    case BrickKind::NormalScore:
+        return 200;
+
+    case BrickKind::LowScore:
+    case BrickKind::MultiBall:
+        return 100;
+    }
+
+    return 0;
+}
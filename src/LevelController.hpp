@@ -1,38 +1,85 @@
-#pragma once
-
-#include "gameobjects/Level.hpp"
-
-#include <SDL3/SDL.h>
-
-#include <memory>
-
-struct Brick;
-class GeometryEngine;
-
-class LevelController
-{
-public:
-    explicit LevelController(std::shared_ptr<GeometryEngine> a_geometryEngine_sp, const Level& a_level);
-    virtual ~LevelController() = default;
-
-    const Level& GetLevel() const;
-    bool GameOver() const;
-
-    SDL_AppResult Iterate(const float a_deltaTimeSec);
-
-    SDL_AppResult HandleKeyboardEvent(const SDL_KeyboardEvent& a_keyEvent);
-    SDL_AppResult HandleMouseMotionEvent(const SDL_MouseMotionEvent& a_mouseMotionEvent, const SDL_FPoint a_levelMousePosition);
-    SDL_AppResult HandleMouseButtonEvent(const SDL_MouseButtonEvent& a_mouseButtonEvent, const SDL_FPoint a_levelMousePosition);
-
-private:
-    void launchBall();
-    void resetBall();
-    void updatePadMovement(const bool a_moveLeft, const bool a_moveRight);
-    void bounceBallFromPad();
-    Uint32 getBrickScore(const Brick& a_brick);
-
-private:
-    std::shared_ptr<GeometryEngine> m_geometryEngine_sp;
-    Level m_level;
-    bool m_gameOver;
+#pragma once
+
+#include "gameobjects/Level.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <memory>
+#include <vector>
+
+struct Ball;
+enum class BrickKind;
+class GeometryEngine;
+struct LevelSnapshot;
+
+class LevelController
+{
+public:
+    explicit LevelController(std::shared_ptr<GeometryEngine> a_geometryEngine_sp, const Level& a_level);
+    virtual ~LevelController() = default;
+
+    // Starts over with a_level as if the controller was just constructed with it. The level is copied into
+    // the storage the controller already holds, so once a level of this size was played a restart is a
+    // plain copy without any heap allocation.
+    void Reset(const Level& a_level);
+
+    const Level& GetLevel() const;
+    bool GameOver() const;
+    void SpawnBalls(const int a_count);
+
+    // Launch angles come from this seed only, so equal seeds and inputs replay identically
+    void SetRandomSeed(const Uint64 a_seed);
+    Uint64 StateHash() const;
+    Uint32 GetNarrowphaseTestCount() const;
+    // Bricks hit during the last Iterate in hit order, a brick hit twice is listed twice
+    const std::vector<Uint32>& GetHitBricks() const;
+
+    // Copies the state the simulation changes into a_snapshot. Fails when the level has more balls or
+    // bricks than a snapshot can hold.
+    bool Snapshot(LevelSnapshot& a_snapshot) const;
+    // Returns to the state of a snapshot taken from this level, later ticks replay exactly as they did
+    // after the snapshot was taken
+    bool Restore(const LevelSnapshot& a_snapshot);
+
+    SDL_AppResult Iterate(const float a_deltaTimeSec);
+
+    SDL_AppResult HandleKeyboardEvent(const SDL_KeyboardEvent& a_keyEvent);
+    SDL_AppResult HandleMouseMotionEvent(const SDL_MouseMotionEvent& a_mouseMotionEvent, const SDL_FPoint a_levelMousePosition);
+    SDL_AppResult HandleMouseButtonEvent(const SDL_MouseButtonEvent& a_mouseButtonEvent, const SDL_FPoint a_levelMousePosition);
+
+private:
+    void launchBalls();
+    void placeBallOnPad(Ball& a_ball);
+    void addBallOnPad();
+    bool keepBallInBounds(Ball& a_ball);
+    void updatePadMovement(const bool a_moveLeft, const bool a_moveRight);
+    void bounceBallFromPad(Ball& a_ball);
+    SDL_FPoint getPadBounceVelocity(const float a_contactX) const;
+    void collideBallWithBricks(Ball& a_ball, const SDL_FPoint& a_previousBallCenter);
+    // Full collision response for the candidate bricks the overlap test marked as hits
+    template <typename TBall>
+    void resolveBrickHits(CircleGeometry& a_ballGeometry, const int a_candidateCount);
+    void moveBallThroughBricks(Ball& a_ball, const float a_deltaTimeSec);
+    void hitBrick(const Uint32 a_brickIndex, const SDL_FPoint& a_ballCenter);
+    void spawnPendingBalls();
+    void collideBalls();
+    Uint32 getBrickScore(const BrickKind a_brickKind);
+
+private:
+    std::shared_ptr<GeometryEngine> m_geometryEngine_sp;
+    Level m_level;
+    bool m_gameOver;
+    Uint64 m_randomState;
+
+    std::vector<SDL_FPoint> m_previousBallCenters;
+    std::vector<SDL_FPoint> m_pendingBallSpawns;
+    std::vector<Uint32> m_ballOrder;
+    std::vector<Uint32> m_brickCandidates;
+    std::vector<float> m_candidateX;
+    std::vector<float> m_candidateY;
+    std::vector<float> m_candidateW;
+    std::vector<float> m_candidateH;
+    std::vector<Uint32> m_candidateHitMask;
+    std::vector<Uint32> m_hitBricks;
+    Uint32 m_narrowphaseTests;
 };
\ No newline at end of file
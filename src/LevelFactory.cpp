@@ -1,116 +1,571 @@
-#include "LevelFactory.hpp"
-
-#include "gameobjects/Level.hpp"
-
-namespace
-{
-
-const float LevelBoundsMargin = 80.0f;
-const float DefaultBrickHeight = 35.0f;
-const float DefaultBrickWidth = 70.0f;
-const float DefaultBrickSpacing = 15.0f;
-
-const float DefaultPadWidth = 140.0f;
-const float DefaultPadHeight = 25.0f;
-
-}
-
-Level
-LevelFactory::CreateLevel(const SDL_FRect& a_levelBounds)
-{
-    Level level;
-    level.bounds = a_levelBounds;
-
-    level.bricks.clear();
-
-    const int bricksPerRow = 5;
-    const SDL_FPoint brickSize{DefaultBrickWidth, DefaultBrickHeight};
-
-    float yOffset = LevelBoundsMargin;
-
-    for (int row = 0; row < 7; row++)
-    {
-        switch (row)
-        {
-        case 0:
-            addBrickRow(level, yOffset, DefaultBrickSpacing, brickSize, {BrickKind::NormalScore,BrickKind::LowScore, BrickKind::NormalScore, BrickKind::HighScore, BrickKind::NormalScore, BrickKind::LowScore, BrickKind::NormalScore});
-            break;
-
-        case 1:
-            addBrickRow(level, yOffset, DefaultBrickSpacing, brickSize, {BrickKind::NormalScore, BrickKind::HighScore, BrickKind::HighScore, BrickKind::HighScore, BrickKind::NormalScore});
-            break;
-
-        case 2:
-            addBrickRow(level, yOffset, DefaultBrickSpacing, brickSize, {BrickKind::HighScore, std::nullopt, std::nullopt, std::nullopt, BrickKind::HighScore});
-            break;
-
-        case 3:
-            addBrickRow(level, yOffset, DefaultBrickSpacing, brickSize, {BrickKind::NormalScore, BrickKind::NormalScore, std::nullopt, BrickKind::NormalScore, BrickKind::NormalScore});
-            break;
-
-        case 4:
-            addBrickRow(level, yOffset, DefaultBrickSpacing, brickSize, {BrickKind::LowScore, BrickKind::LowScore, std::nullopt, BrickKind::LowScore, BrickKind::LowScore});
-            break;
-
-        case 5:
-            addBrickRow(level, yOffset, DefaultBrickSpacing, brickSize, {BrickKind::LowScore, BrickKind::LowScore, std::nullopt, BrickKind::LowScore, BrickKind::LowScore});
-            break;
-
-        default:
-            addBrickRow(level, yOffset, DefaultBrickSpacing, brickSize, {BrickKind::LowScore, BrickKind::LowScore, BrickKind::HighScore, BrickKind::LowScore, BrickKind::LowScore});
-            break;
-        }
-
-        yOffset += DefaultBrickSpacing + DefaultBrickHeight;
-    }
-
-    level.pad.geometry.properties.isSolid = true;
-    level.pad.geometry.properties.isVisible = true;
-    
-    level.pad.geometry.rect.w = DefaultPadWidth;
-    level.pad.geometry.rect.h = DefaultPadHeight;
-    level.pad.geometry.rect.x = a_levelBounds.x + (a_levelBounds.w / 2.0f) - (level.pad.geometry.rect.w / 2.0);
-    level.pad.geometry.rect.y = a_levelBounds.y + a_levelBounds.h - LevelBoundsMargin - level.pad.geometry.rect.h;
-    
-    level.pad.speed = Constants::StartingPadSpeed;
-
-    level.ball.geometry.properties.isSolid = true;
-    level.ball.geometry.properties.isVisible = true;
-    level.ball.geometry.radius = Constants::StartingBallSize / 2.0f;
-    level.paused = false;
-    level.balls = 3;
-    level.score = 0;
-
-    return level;
-}
-
-void
-LevelFactory::addBrickRow(Level &a_level,
-                          const float a_yOffset,
-                          const float a_spacing,
-                          const SDL_FPoint& a_brickSize,
-                          const std::vector<std::optional<BrickKind>> a_bricksToAdd) const
-{
-    const float totalRowWidth = a_brickSize.x * a_bricksToAdd.size() + (a_bricksToAdd.size() - 1) * a_spacing;
-    float currentX = a_level.bounds.x + a_level.bounds.w / 2.0f - totalRowWidth / 2.0f;
-
-    for (const auto& brickType : a_bricksToAdd)
-    {
-        if (brickType.has_value())
-        {
-            Brick brick;
-            brick.geometry.properties.isSolid = true;
-            brick.geometry.properties.isVisible = true;
-            brick.geometry.rect.x = currentX;
-            brick.geometry.rect.y = a_level.bounds.y + a_yOffset;
-            brick.geometry.rect.w = a_brickSize.x;
-            brick.geometry.rect.h = a_brickSize.y;
-            brick.hitPoints = 1;
-            brick.kind = brickType.value();
-
-            a_level.bricks.push_back(brick);
-        }
-
-        currentX += a_brickSize.x + a_spacing;
-    }
-}
+#include "LevelFactory.hpp"
+
+#include "MappedFile.hpp"
+#include "ThreadPool.hpp"
+#include "gameobjects/Level.hpp"
+
+namespace
+{
+
+const float LevelBoundsMargin = 80.0f;
+
+// Height kept free below the bricks of a stress level for the pad and the balls
+const float StressLevelPlayHeight = 400.0f;
+const float StressLevelMinDensity = 0.01f;
+// Smaller stress levels are generated on the calling thread, starting the workers would cost more than it saves
+const Uint32 ParallelStressLevelMinBricks = 1u << 16;
+// Row chunks handed to each worker, more than one evens out rows that finish early
+const int StressChunksPerWorker = 4;
+
+const char DefaultLevelText[] =
+    "# Built-in level, the same format as the files in levels/\n"
+    "brick 70 35\n"
+    "spacing 15\n"
+    "margin 80\n"
+    "pad 140 25\n"
+    "balls 3\n"
+    "row NLNHNLN\n"
+    "row NHHHN\n"
+    "row H.M.H\n"
+    "row NN.NN\n"
+    "row LL.LL\n"
+    "row LL.LL\n"
+    "row LLHLL\n";
+
+Uint64
+hashPath(const char* a_path)
+{
+    // FNV-1a
+    Uint64 hash = 0xcbf29ce484222325ull;
+    for (const char* character_p = a_path; *character_p; character_p++)
+    {
+        hash = (hash ^ (Uint8)*character_p) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+bool
+isSpace(const char a_character)
+{
+    return a_character == ' ' || a_character == '\t' || a_character == '\r';
+}
+
+void
+skipSpaces(const char*& a_cursor_p, const char* a_end_p)
+{
+    while (a_cursor_p < a_end_p && isSpace(*a_cursor_p))
+    {
+        a_cursor_p++;
+    }
+}
+
+// Reads the next word of the line, a_word_p and a_length are left pointing into the text
+void
+readWord(const char*& a_cursor_p, const char* a_end_p, const char*& a_word_p, size_t& a_length)
+{
+    skipSpaces(a_cursor_p, a_end_p);
+    a_word_p = a_cursor_p;
+    while (a_cursor_p < a_end_p && !isSpace(*a_cursor_p))
+    {
+        a_cursor_p++;
+    }
+    a_length = (size_t)(a_cursor_p - a_word_p);
+}
+
+// Returns a_end_p when the character does not occur
+const char*
+findCharacter(const char* a_begin_p, const char* a_end_p, const char a_character)
+{
+    while (a_begin_p < a_end_p && *a_begin_p != a_character)
+    {
+        a_begin_p++;
+    }
+    return a_begin_p;
+}
+
+bool
+wordEquals(const char* a_word_p, const size_t a_length, const char* a_keyword_p)
+{
+    return SDL_strlen(a_keyword_p) == a_length && SDL_strncmp(a_word_p, a_keyword_p, a_length) == 0;
+}
+
+// Plain decimal numbers only. The mapped text is not null terminated, so the SDL_strto* functions could
+// read past its end.
+bool
+readNumber(const char*& a_cursor_p, const char* a_end_p, float& a_value)
+{
+    skipSpaces(a_cursor_p, a_end_p);
+
+    bool negative = false;
+    if (a_cursor_p < a_end_p && *a_cursor_p == '-')
+    {
+        negative = true;
+        a_cursor_p++;
+    }
+
+    bool hasDigits = false;
+    double value = 0.0;
+    while (a_cursor_p < a_end_p && *a_cursor_p >= '0' && *a_cursor_p <= '9')
+    {
+        value = value * 10.0 + (*a_cursor_p - '0');
+        hasDigits = true;
+        a_cursor_p++;
+    }
+
+    if (a_cursor_p < a_end_p && *a_cursor_p == '.')
+    {
+        a_cursor_p++;
+        double scale = 0.1;
+        while (a_cursor_p < a_end_p && *a_cursor_p >= '0' && *a_cursor_p <= '9')
+        {
+            value += (*a_cursor_p - '0') * scale;
+            scale *= 0.1;
+            hasDigits = true;
+            a_cursor_p++;
+        }
+    }
+
+    a_value = (float)(negative ? -value : value);
+    return hasDigits && (a_cursor_p == a_end_p || isSpace(*a_cursor_p));
+}
+
+// Brick grid of a stress level, shared read-only by all threads generating its rows
+struct StressGrid
+{
+    Uint64 seed;
+    Uint32 brickCount;
+    Uint32 rows;
+    Uint32 columns;
+    float firstX;
+    float firstY;
+    float cellWidth;
+    float cellHeight;
+    SDL_FPoint brickSize;
+    // Running sums of the kind weights
+    float kindThresholds[BrickKindCount];
+};
+
+// Every row gets an equal share of the bricks, so the brick indices of a row are known up front
+Uint32
+firstBrickOfRow(const StressGrid& a_grid, const Uint32 a_row)
+{
+    return (Uint32)((Uint64)a_row * a_grid.brickCount / a_grid.rows);
+}
+
+BrickKind
+pickBrickKind(const StressGrid& a_grid, const float a_random)
+{
+    const float value = a_random * a_grid.kindThresholds[BrickKindCount - 1];
+    for (int kind = 0; kind < BrickKindCount - 1; kind++)
+    {
+        if (value < a_grid.kindThresholds[kind])
+        {
+            return (BrickKind)kind;
+        }
+    }
+    return (BrickKind)(BrickKindCount - 1);
+}
+
+void
+generateStressRows(const StressGrid& a_grid, const Uint32 a_firstRow, const Uint32 a_endRow, BrickStore& a_bricks)
+{
+    for (Uint32 row = a_firstRow; row < a_endRow; row++)
+    {
+        // Each row has its own random state, the level does not depend on how the rows are split over threads
+        Uint64 randomState = a_grid.seed ^ ((Uint64)(row + 1) * 0x9e3779b97f4a7c15ull);
+        Uint32 brickIndex = firstBrickOfRow(a_grid, row);
+        Uint32 neededBricks = firstBrickOfRow(a_grid, row + 1) - brickIndex;
+        const float y = a_grid.firstY + row * a_grid.cellHeight;
+
+        for (Uint32 column = 0; neededBricks > 0 && column < a_grid.columns; column++)
+        {
+            // Selection sampling, picks exactly the needed number of cells with every cell equally likely
+            if ((Uint32)SDL_rand_r(&randomState, (Sint32)(a_grid.columns - column)) >= neededBricks)
+            {
+                continue;
+            }
+
+            a_bricks.x[brickIndex] = a_grid.firstX + column * a_grid.cellWidth;
+            a_bricks.y[brickIndex] = y;
+            a_bricks.w[brickIndex] = a_grid.brickSize.x;
+            a_bricks.h[brickIndex] = a_grid.brickSize.y;
+            a_bricks.kind[brickIndex] = pickBrickKind(a_grid, SDL_randf_r(&randomState));
+            a_bricks.hitPoints[brickIndex] = 1;
+
+            brickIndex++;
+            neededBricks--;
+        }
+    }
+}
+
+bool
+cellForCharacter(const char a_character, Uint8& a_cell)
+{
+    switch (a_character)
+    {
+    case '.':
+        a_cell = LevelLayout::EmptyCell;
+        return true;
+
+    case 'L':
+        a_cell = (Uint8)BrickKind::LowScore;
+        return true;
+
+    case 'N':
+        a_cell = (Uint8)BrickKind::NormalScore;
+        return true;
+
+    case 'H':
+        a_cell = (Uint8)BrickKind::HighScore;
+        return true;
+
+    case 'S':
+        a_cell = (Uint8)BrickKind::Solid;
+        return true;
+
+    case 'M':
+        a_cell = (Uint8)BrickKind::MultiBall;
+        return true;
+    }
+
+    return false;
+}
+
+}
+
+LevelFactory::LevelFactory()
+{
+    ParseLayout(DefaultLevelText, sizeof(DefaultLevelText) - 1, "built-in level", m_defaultLayout);
+}
+
+Level
+LevelFactory::CreateLevel(const SDL_FRect& a_levelBounds)
+{
+    Level level;
+    buildLevel(m_defaultLayout, a_levelBounds, level);
+
+    return level;
+}
+
+void
+LevelFactory::CreateLevel(const SDL_FRect& a_levelBounds, Level& a_level) const
+{
+    buildLevel(m_defaultLayout, a_levelBounds, a_level);
+}
+
+bool
+LevelFactory::LoadLevel(const char* a_path, const SDL_FRect& a_levelBounds, Level& a_level)
+{
+    // Keyed by a hash of the path, a lookup does not have to build a std::string
+    const Uint64 pathHash = hashPath(a_path);
+    auto cachedLayout = m_layoutCache.find(pathHash);
+    if (cachedLayout == m_layoutCache.end() || cachedLayout->second.path != a_path)
+    {
+        MappedFile file;
+        if (!file.Open(a_path))
+        {
+            return false;
+        }
+
+        CachedLayout parsedLayout;
+        parsedLayout.path = a_path;
+        if (!ParseLayout((const char*)file.Data(), file.Size(), a_path, parsedLayout.layout))
+        {
+            return false;
+        }
+
+        // A different path with the same hash just replaces the cached one
+        cachedLayout = m_layoutCache.insert_or_assign(pathHash, std::move(parsedLayout)).first;
+    }
+
+    // Bricks outside the bounds could never be hit, the level would never be cleared
+    const LevelLayout& layout = cachedLayout->second.layout;
+    const float widestRowWidth = layout.RowWidth(layout.widestRow);
+    if (widestRowWidth > a_levelBounds.w)
+    {
+        SDL_Log("%s: row %u is %.0f units wide, the level is only %.0f", a_path, layout.widestRow + 1, widestRowWidth, a_levelBounds.w);
+        return false;
+    }
+
+    buildLevel(layout, a_levelBounds, a_level);
+
+    return true;
+}
+
+void
+LevelFactory::ClearLayoutCache()
+{
+    m_layoutCache.clear();
+}
+
+void
+LevelFactory::CreateStressLevel(const SDL_FRect& a_levelBounds, const StressLevelOptions& a_options, Level& a_level) const
+{
+    StressGrid grid;
+    grid.seed = a_options.seed;
+    grid.brickCount = SDL_max(a_options.brickCount, 1u);
+    grid.brickSize = a_options.brickSize;
+    grid.cellWidth = a_options.brickSize.x + a_options.brickSpacing;
+    grid.cellHeight = a_options.brickSize.y + a_options.brickSpacing;
+
+    float totalWeight = 0.0f;
+    for (int kind = 0; kind < BrickKindCount; kind++)
+    {
+        totalWeight += SDL_max(a_options.kindWeights[kind], 0.0f);
+        grid.kindThresholds[kind] = totalWeight;
+    }
+    if (totalWeight <= 0.0f)
+    {
+        SDL_Log("Stress level has no brick kind with a positive weight, using normal score bricks");
+        for (int kind = 0; kind < BrickKindCount; kind++)
+        {
+            grid.kindThresholds[kind] = kind >= (int)BrickKind::NormalScore ? 1.0f : 0.0f;
+        }
+    }
+
+    // The brick area is as wide as the given bounds, or roughly square once it would get too tall. Fitted
+    // levels shape the area like the free space of the bounds instead and shrink the bricks into it.
+    const float density = SDL_clamp(a_options.density, StressLevelMinDensity, 1.0f);
+    const Uint64 cellCount = (Uint64)SDL_ceil(grid.brickCount / (double)density);
+    const float availableWidth = SDL_max(a_levelBounds.w - 2.0f * LevelBoundsMargin, grid.cellWidth);
+    const float availableHeight = SDL_max(a_levelBounds.h - LevelBoundsMargin - StressLevelPlayHeight, grid.cellHeight);
+    const double areaAspect = a_options.fitBounds ? availableWidth / (double)availableHeight : 1.0;
+    const Uint64 fittingColumns = (Uint64)SDL_max((availableWidth + a_options.brickSpacing) / grid.cellWidth, 1.0f);
+    const Uint64 shapedColumns = (Uint64)SDL_ceil(SDL_sqrt(cellCount * areaAspect * grid.cellHeight / grid.cellWidth));
+    grid.columns = (Uint32)SDL_min(SDL_max(fittingColumns, shapedColumns), cellCount);
+    grid.rows = (Uint32)((cellCount + grid.columns - 1) / grid.columns);
+
+    float brickSpacing = a_options.brickSpacing;
+    if (a_options.fitBounds)
+    {
+        const float scale = SDL_min(SDL_min((availableWidth + brickSpacing) / (grid.columns * grid.cellWidth),
+                                            (availableHeight + brickSpacing) / (grid.rows * grid.cellHeight)),
+                                    1.0f);
+        grid.brickSize.x *= scale;
+        grid.brickSize.y *= scale;
+        grid.cellWidth *= scale;
+        grid.cellHeight *= scale;
+        brickSpacing *= scale;
+    }
+
+    const float bricksWidth = grid.columns * grid.cellWidth - brickSpacing;
+    const float bricksHeight = grid.rows * grid.cellHeight - brickSpacing;
+    a_level.bounds = a_levelBounds;
+    a_level.bounds.w = SDL_max(a_levelBounds.w, bricksWidth + 2.0f * LevelBoundsMargin);
+    a_level.bounds.h = SDL_max(a_levelBounds.h, LevelBoundsMargin + bricksHeight + StressLevelPlayHeight);
+    grid.firstX = a_level.bounds.x + a_level.bounds.w / 2.0f - bricksWidth / 2.0f;
+    grid.firstY = a_level.bounds.y + LevelBoundsMargin;
+
+    // Sized once, every row writes straight into its own slice of the arrays
+    a_level.bricks.Clear();
+    a_level.bricks.Resize(grid.brickCount);
+
+    if (a_options.threadCount == 1 || grid.brickCount < ParallelStressLevelMinBricks)
+    {
+        generateStressRows(grid, 0, grid.rows, a_level.bricks);
+    }
+    else
+    {
+        ThreadPool threadPool(a_options.threadCount);
+        const Uint32 chunkCount = SDL_min((Uint32)(threadPool.WorkerCount() * StressChunksPerWorker), grid.rows);
+        for (Uint32 chunk = 0; chunk < chunkCount; chunk++)
+        {
+            const Uint32 firstRow = (Uint32)((Uint64)chunk * grid.rows / chunkCount);
+            const Uint32 endRow = (Uint32)((Uint64)(chunk + 1) * grid.rows / chunkCount);
+            BrickStore& bricks = a_level.bricks;
+            threadPool.Submit([&grid, &bricks, firstRow, endRow](const int)
+            {
+                generateStressRows(grid, firstRow, endRow, bricks);
+            });
+        }
+        threadPool.Wait();
+    }
+
+    const float brickGridCellSize = SDL_max(grid.cellWidth, grid.cellHeight);
+    a_level.brickGrid.Build(a_level.bounds, brickGridCellSize, a_level.bricks);
+
+    const LevelLayout defaultLayout;
+    resetPadAndBalls(a_level, defaultLayout.padSize, defaultLayout.balls);
+}
+
+bool
+LevelFactory::ParseLayout(const char* a_text_p, const size_t a_size, const char* a_sourceName_p, LevelLayout& a_layout)
+{
+    a_layout.Clear();
+
+    // The cells of all rows fit in the text, reserving that avoids growing the arrays row by row
+    a_layout.cells.reserve(a_size);
+
+    const char* cursor_p = a_text_p;
+    const char* textEnd_p = a_text_p + a_size;
+    int lineNumber = 0;
+    while (cursor_p < textEnd_p)
+    {
+        lineNumber++;
+        const char* lineEnd_p = findCharacter(cursor_p, textEnd_p, '\n');
+        const char* contentEnd_p = findCharacter(cursor_p, lineEnd_p, '#');
+
+        const char* keyword_p;
+        size_t keywordLength;
+        readWord(cursor_p, contentEnd_p, keyword_p, keywordLength);
+
+        bool valid = true;
+        if (keywordLength == 0)
+        {
+            // Blank or comment line
+        }
+        else if (wordEquals(keyword_p, keywordLength, "brick"))
+        {
+            valid = readNumber(cursor_p, contentEnd_p, a_layout.brickSize.x) && readNumber(cursor_p, contentEnd_p, a_layout.brickSize.y) &&
+                    a_layout.brickSize.x > 0.0f && a_layout.brickSize.y > 0.0f;
+        }
+        else if (wordEquals(keyword_p, keywordLength, "spacing"))
+        {
+            valid = readNumber(cursor_p, contentEnd_p, a_layout.brickSpacing) && a_layout.brickSpacing >= 0.0f;
+        }
+        else if (wordEquals(keyword_p, keywordLength, "margin"))
+        {
+            valid = readNumber(cursor_p, contentEnd_p, a_layout.topMargin);
+        }
+        else if (wordEquals(keyword_p, keywordLength, "pad"))
+        {
+            valid = readNumber(cursor_p, contentEnd_p, a_layout.padSize.x) && readNumber(cursor_p, contentEnd_p, a_layout.padSize.y) &&
+                    a_layout.padSize.x > 0.0f && a_layout.padSize.y > 0.0f;
+        }
+        else if (wordEquals(keyword_p, keywordLength, "balls"))
+        {
+            float balls;
+            valid = readNumber(cursor_p, contentEnd_p, balls) && balls >= 0.0f;
+            a_layout.balls = (int)balls;
+        }
+        else if (wordEquals(keyword_p, keywordLength, "row"))
+        {
+            const char* row_p;
+            size_t rowLength;
+            readWord(cursor_p, contentEnd_p, row_p, rowLength);
+            valid = rowLength > 0;
+
+            for (size_t i = 0; valid && i < rowLength; i++)
+            {
+                Uint8 cell = LevelLayout::EmptyCell;
+                valid = cellForCharacter(row_p[i], cell);
+                a_layout.cells.push_back(cell);
+                a_layout.brickCount += cell != LevelLayout::EmptyCell ? 1 : 0;
+            }
+            a_layout.rowStarts.push_back((Uint32)a_layout.cells.size());
+
+            const size_t row = a_layout.RowCount() - 1;
+            if (row > 0 && rowLength > a_layout.rowStarts[a_layout.widestRow + 1] - a_layout.rowStarts[a_layout.widestRow])
+            {
+                a_layout.widestRow = (Uint32)row;
+            }
+        }
+        else
+        {
+            valid = false;
+        }
+
+        // Nothing may follow the values of a line
+        skipSpaces(cursor_p, contentEnd_p);
+        if (!valid || cursor_p != contentEnd_p)
+        {
+            SDL_Log("%s:%d: invalid level line", a_sourceName_p, lineNumber);
+            a_layout.Clear();
+            return false;
+        }
+
+        // The last line does not have to end with a newline
+        cursor_p = lineEnd_p < textEnd_p ? lineEnd_p + 1 : textEnd_p;
+    }
+
+    if (a_layout.brickCount == 0)
+    {
+        SDL_Log("%s: level has no bricks", a_sourceName_p);
+        a_layout.Clear();
+        return false;
+    }
+
+    return true;
+}
+
+void
+LevelFactory::buildLevel(const LevelLayout& a_layout, const SDL_FRect& a_levelBounds, Level& a_level) const
+{
+    a_level.bounds = a_levelBounds;
+
+    a_level.bricks.Clear();
+    a_level.bricks.Reserve(a_layout.brickCount);
+
+    float yOffset = a_layout.topMargin;
+    for (size_t row = 0; row < a_layout.RowCount(); row++)
+    {
+        addBrickRow(a_level, a_layout, row, yOffset);
+        yOffset += a_layout.brickSpacing + a_layout.brickSize.y;
+    }
+
+    const float brickGridCellSize = SDL_max(a_layout.brickSize.x, a_layout.brickSize.y) + a_layout.brickSpacing;
+    a_level.brickGrid.Build(a_levelBounds, brickGridCellSize, a_level.bricks);
+
+    resetPadAndBalls(a_level, a_layout.padSize, a_layout.balls);
+}
+
+void
+LevelFactory::resetPadAndBalls(Level& a_level, const SDL_FPoint& a_padSize, const int a_balls) const
+{
+    const SDL_FRect& levelBounds = a_level.bounds;
+
+    a_level.pad.geometry.properties.isSolid = true;
+    a_level.pad.geometry.properties.isVisible = true;
+
+    a_level.pad.geometry.rect.w = a_padSize.x;
+    a_level.pad.geometry.rect.h = a_padSize.y;
+    a_level.pad.geometry.rect.x = levelBounds.x + (levelBounds.w / 2.0f) - (a_level.pad.geometry.rect.w / 2.0);
+    a_level.pad.geometry.rect.y = levelBounds.y + levelBounds.h - LevelBoundsMargin - a_level.pad.geometry.rect.h;
+    a_level.pad.geometry.properties.velocity.reset();
+    a_level.pad.movingLeft = false;
+    a_level.pad.movingRight = false;
+
+    a_level.pad.speed = Constants::StartingPadSpeed;
+
+    // The ball waits on the pad until launched, LevelController keeps it positioned there
+    Ball ball;
+    ball.geometry.properties.isSolid = true;
+    ball.geometry.properties.isVisible = true;
+    ball.geometry.radius = Constants::StartingBallSize / 2.0f;
+    a_level.ballsInPlay.clear();
+    a_level.ballsInPlay.push_back(ball);
+
+    a_level.paused = false;
+    a_level.balls = a_balls;
+    a_level.score = 0;
+}
+
+void
+LevelFactory::addBrickRow(Level& a_level, const LevelLayout& a_layout, const size_t a_row, const float a_yOffset) const
+{
+    const Uint32 firstCell = a_layout.rowStarts[a_row];
+    const Uint32 cellCount = a_layout.rowStarts[a_row + 1] - firstCell;
+    const float totalRowWidth = a_layout.brickSize.x * cellCount + (cellCount - 1) * a_layout.brickSpacing;
+    float currentX = a_level.bounds.x + a_level.bounds.w / 2.0f - totalRowWidth / 2.0f;
+
+    Brick brick;
+    brick.geometry.properties.isSolid = true;
+    brick.geometry.properties.isVisible = true;
+    brick.geometry.rect.y = a_level.bounds.y + a_yOffset;
+    brick.geometry.rect.w = a_layout.brickSize.x;
+    brick.geometry.rect.h = a_layout.brickSize.y;
+    brick.hitPoints = 1;
+
+    for (Uint32 cell = firstCell; cell < firstCell + cellCount; cell++)
+    {
+        if (a_layout.cells[cell] != LevelLayout::EmptyCell)
+        {
+            brick.geometry.rect.x = currentX;
+            brick.kind = (BrickKind)a_layout.cells[cell];
+
+            a_level.bricks.Add(brick);
+        }
+
+        currentX += a_layout.brickSize.x + a_layout.brickSpacing;
+    }
+}
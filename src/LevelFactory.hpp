@@ -1,25 +1,69 @@
-#pragma once
-
-struct Level;
-struct SDL_FPoint;
-struct SDL_FRect;
-
-#include <optional>
-#include <vector>
-
-enum class BrickKind;
-
-class LevelFactory
-{
-public:
-    virtual ~LevelFactory() = default;
-
-    Level CreateLevel(const SDL_FRect& a_levelBounds);
-
-private:
-    void addBrickRow(Level& a_level,
-                     const float a_yOffset,
-                     const float a_spacing,
-                     const SDL_FPoint& a_brickSize,
-                     const std::vector<std::optional<BrickKind>> a_bricksToAdd) const;
-};
\ No newline at end of file
+#pragma once
+
+#include "gameobjects/Brick.hpp"
+#include "gameobjects/LevelLayout.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <string>
+#include <unordered_map>
+
+struct Level;
+
+// Settings of a generated stress level
+struct StressLevelOptions
+{
+    Uint64 seed = 1;
+    Uint32 brickCount = 1000;
+    // Share of the cells of the brick area that hold a brick, the area is sized to fit brickCount
+    float density = 0.75f;
+    SDL_FPoint brickSize{70.0f, 35.0f};
+    float brickSpacing = 15.0f;
+    // Relative weights of the brick kinds, indexed by BrickKind
+    float kindWeights[BrickKindCount] = {4.0f, 3.0f, 2.0f, 0.0f, 1.0f};
+    // Shrinks the bricks until they fit the given bounds instead of growing the level bounds
+    bool fitBounds = false;
+    // Threads used for large levels, 0 uses one per logical CPU core and 1 generates on the calling thread
+    int threadCount = 0;
+};
+
+class LevelFactory
+{
+public:
+    LevelFactory();
+    virtual ~LevelFactory() = default;
+
+    // Builds the built-in level
+    Level CreateLevel(const SDL_FRect& a_levelBounds);
+    // Same, reusing the storage a_level already has
+    void CreateLevel(const SDL_FRect& a_levelBounds, Level& a_level) const;
+
+    // Builds the level of a level file into a_level, reusing the storage a_level already has. Each file is
+    // memory-mapped and parsed once, loading the same path again only rebuilds the level from the cached
+    // layout. Edited files are not noticed until ClearLayoutCache is called.
+    bool LoadLevel(const char* a_path, const SDL_FRect& a_levelBounds, Level& a_level);
+    void ClearLayoutCache();
+
+    // Builds a seeded random level into a_level, the same options always give the same level. Unless the
+    // options fit the bricks into a_levelBounds, the level bounds grow to keep the play area below them. Large
+    // levels are generated by several threads, each filling its own rows.
+    void CreateStressLevel(const SDL_FRect& a_levelBounds, const StressLevelOptions& a_options, Level& a_level) const;
+
+    // Parses the text of a level file, a_sourceName_p only appears in the error messages
+    static bool ParseLayout(const char* a_text_p, const size_t a_size, const char* a_sourceName_p, LevelLayout& a_layout);
+
+private:
+    void buildLevel(const LevelLayout& a_layout, const SDL_FRect& a_levelBounds, Level& a_level) const;
+    void addBrickRow(Level& a_level, const LevelLayout& a_layout, const size_t a_row, const float a_yOffset) const;
+    void resetPadAndBalls(Level& a_level, const SDL_FPoint& a_padSize, const int a_balls) const;
+
+private:
+    struct CachedLayout
+    {
+        std::string path;
+        LevelLayout layout;
+    };
+
+    LevelLayout m_defaultLayout;
+    std::unordered_map<Uint64, CachedLayout> m_layoutCache;
+};
@@ -0,0 +1,136 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : m_data_p(nullptr)
+    , m_size(0)
+#ifdef _WIN32
+    , m_fileHandle_p(INVALID_HANDLE_VALUE)
+    , m_mappingHandle_p(nullptr)
+#else
+    , m_fileDescriptor(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool
+MappedFile::Open(const char* a_path)
+{
+    Close();
+
+#ifdef _WIN32
+    m_fileHandle_p = CreateFileA(a_path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_fileHandle_p == INVALID_HANDLE_VALUE)
+    {
+        SDL_Log("Couldn't open %s", a_path);
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_fileHandle_p, &fileSize) || fileSize.QuadPart == 0)
+    {
+        SDL_Log("Couldn't map empty or unreadable file %s", a_path);
+        Close();
+        return false;
+    }
+
+    m_mappingHandle_p = CreateFileMappingA(m_fileHandle_p, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mappingHandle_p)
+    {
+        SDL_Log("Couldn't map %s", a_path);
+        Close();
+        return false;
+    }
+
+    m_data_p = (const Uint8*)MapViewOfFile(m_mappingHandle_p, FILE_MAP_READ, 0, 0, 0);
+    m_size = (size_t)fileSize.QuadPart;
+#else
+    m_fileDescriptor = open(a_path, O_RDONLY);
+    if (m_fileDescriptor < 0)
+    {
+        SDL_Log("Couldn't open %s", a_path);
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(m_fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        SDL_Log("Couldn't map empty or unreadable file %s", a_path);
+        Close();
+        return false;
+    }
+
+    void* mapping_p = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, m_fileDescriptor, 0);
+    m_data_p = mapping_p != MAP_FAILED ? (const Uint8*)mapping_p : nullptr;
+    m_size = (size_t)fileStat.st_size;
+#endif
+
+    if (!m_data_p)
+    {
+        SDL_Log("Couldn't map %s", a_path);
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void
+MappedFile::Close()
+{
+#ifdef _WIN32
+    if (m_data_p)
+    {
+        UnmapViewOfFile(m_data_p);
+    }
+    if (m_mappingHandle_p)
+    {
+        CloseHandle(m_mappingHandle_p);
+        m_mappingHandle_p = nullptr;
+    }
+    if (m_fileHandle_p != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_fileHandle_p);
+        m_fileHandle_p = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_data_p)
+    {
+        munmap((void*)m_data_p, m_size);
+    }
+    if (m_fileDescriptor >= 0)
+    {
+        close(m_fileDescriptor);
+        m_fileDescriptor = -1;
+    }
+#endif
+
+    m_data_p = nullptr;
+    m_size = 0;
+}
+
+const Uint8*
+MappedFile::Data() const
+{
+    return m_data_p;
+}
+
+size_t
+MappedFile::Size() const
+{
+    return m_size;
+}
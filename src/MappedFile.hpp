@@ -0,0 +1,31 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+// Read-only memory mapping of a whole file. The contents are used in place, nothing is copied or parsed.
+class MappedFile
+{
+public:
+    MappedFile();
+    virtual ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const char* a_path);
+    void Close();
+
+    const Uint8* Data() const;
+    size_t Size() const;
+
+private:
+    const Uint8* m_data_p;
+    size_t m_size;
+
+#ifdef _WIN32
+    void* m_fileHandle_p;
+    void* m_mappingHandle_p;
+#else
+    int m_fileDescriptor;
+#endif
+};
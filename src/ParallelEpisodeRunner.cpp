@@ -0,0 +1,87 @@
+#include "ParallelEpisodeRunner.hpp"
+
+#include "GeometryEngine.hpp"
+#include "LevelFactory.hpp"
+
+namespace
+{
+
+// Episodes are handed out in batches to keep the scheduling overhead low, but there are still several
+// batches per worker so that workers which draw short episodes can steal from the others
+const int BatchesPerWorker = 8;
+
+}
+
+ParallelEpisodeRunner::ParallelEpisodeRunner(const SDL_FRect& a_levelBounds, const int a_workerCount)
+    : m_threadPool(a_workerCount)
+{
+    for (int i = 0; i < m_threadPool.WorkerCount(); i++)
+    {
+        m_workerRunners.push_back(std::make_unique<HeadlessRunner>(std::make_shared<LevelFactory>(),
+                                                                   std::make_shared<GeometryEngine>(),
+                                                                   a_levelBounds));
+    }
+}
+
+int
+ParallelEpisodeRunner::WorkerCount() const
+{
+    return m_threadPool.WorkerCount();
+}
+
+Uint64
+ParallelEpisodeRunner::StolenTaskCount() const
+{
+    return m_threadPool.StolenTaskCount();
+}
+
+void
+ParallelEpisodeRunner::SetStressLevel(const StressLevelOptions& a_options)
+{
+    StressLevelOptions workerOptions = a_options;
+    if (m_threadPool.WorkerCount() > 1)
+    {
+        workerOptions.threadCount = 1;
+    }
+
+    for (std::unique_ptr<HeadlessRunner>& runner : m_workerRunners)
+    {
+        runner->SetStressLevel(workerOptions);
+    }
+}
+
+void
+ParallelEpisodeRunner::RunEpisodes(const Uint64 a_firstSeed,
+                                   const int a_episodeCount,
+                                   const Uint64 a_maxTicks,
+                                   const Uint32 a_tickRateHz,
+                                   const int a_extraBalls,
+                                   InputRecorder* a_recorder_p,
+                                   std::vector<EpisodeResult>& a_results)
+{
+    a_results.assign(SDL_max(a_episodeCount, 0), EpisodeResult());
+
+    const int batchCount = SDL_max(m_threadPool.WorkerCount() * BatchesPerWorker, 1);
+    const int batchSize = SDL_max((a_episodeCount + batchCount - 1) / batchCount, 1);
+
+    // Every batch writes a disjoint range of the results, so they need no locking
+    EpisodeResult* results_p = a_results.data();
+    for (int first = 0; first < a_episodeCount; first += batchSize)
+    {
+        const int last = SDL_min(first + batchSize, a_episodeCount);
+        m_threadPool.Submit([=](const int a_workerIndex)
+        {
+            HeadlessRunner& runner = *m_workerRunners[a_workerIndex];
+            for (int episode = first; episode < last; episode++)
+            {
+                results_p[episode] = runner.RunEpisode(a_firstSeed + episode,
+                                                       a_maxTicks,
+                                                       a_tickRateHz,
+                                                       a_extraBalls,
+                                                       episode == 0 ? a_recorder_p : nullptr);
+            }
+        });
+    }
+
+    m_threadPool.Wait();
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "HeadlessRunner.hpp"
+#include "ThreadPool.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <memory>
+#include <vector>
+
+class InputRecorder;
+
+// Runs many independent headless episodes on a work-stealing ThreadPool. Every worker owns its own
+// HeadlessRunner, LevelFactory and GeometryEngine, so episodes share no mutable state and the results
+// do not depend on the number of workers.
+class ParallelEpisodeRunner
+{
+public:
+    // a_workerCount <= 0 uses one worker per logical CPU core
+    ParallelEpisodeRunner(const SDL_FRect& a_levelBounds, const int a_workerCount);
+    virtual ~ParallelEpisodeRunner() = default;
+
+    int WorkerCount() const;
+    Uint64 StolenTaskCount() const;
+
+    // Every worker plays the same generated stress level instead of the built-in one. With more than one
+    // worker the level is generated on the worker's own thread, the workers already keep every core busy.
+    void SetStressLevel(const StressLevelOptions& a_options);
+
+    // Episode i is played with seed a_firstSeed + i and its result is stored at index i.
+    // a_recorder_p is optional, when given the first episode is recorded into it.
+    void RunEpisodes(const Uint64 a_firstSeed,
+                     const int a_episodeCount,
+                     const Uint64 a_maxTicks,
+                     const Uint32 a_tickRateHz,
+                     const int a_extraBalls,
+                     InputRecorder* a_recorder_p,
+                     std::vector<EpisodeResult>& a_results);
+
+private:
+    ThreadPool m_threadPool;
+    std::vector<std::unique_ptr<HeadlessRunner>> m_workerRunners;
+};
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include "Profiler.hpp"
+
+#ifdef ARKANOID_PROFILING
+
+namespace
+{
+
+const char* const PhaseNames[(int)ProfilePhase::Count] = {
+    "Frame",
+    "Simulation",
+    "LevelIterate",
+    "BallMovement",
+    "BrickCollision",
+    "BallCollision",
+    "RenderLevel",
+    "RenderBrickLayer",
+    "RenderPresent"
+};
+
+// Threads beyond this many share the last trace row
+const int MaxTraceThreads = 64;
+
+}
+
+Profiler&
+Profiler::Instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : m_samples(RingCapacity)
+{
+    Reset();
+}
+
+void
+Profiler::Record(const ProfilePhase a_phase, const Uint64 a_startNS, const Uint64 a_endNS)
+{
+    const Uint32 durationNS = (Uint32)SDL_min(a_endNS - a_startNS, (Uint64)SDL_MAX_UINT32);
+
+    Histogram& histogram = m_histograms[(int)a_phase];
+    SDL_AddAtomicInt(&histogram.buckets[bucketForDuration(durationNS)], 1);
+    SDL_AddAtomicInt(&histogram.samples, 1);
+    Uint32 maxNS = SDL_GetAtomicU32(&histogram.maxNS);
+    while (durationNS > maxNS && !SDL_CompareAndSwapAtomicU32(&histogram.maxNS, maxNS, durationNS))
+    {
+        maxNS = SDL_GetAtomicU32(&histogram.maxNS);
+    }
+
+    // Every writer owns the slot of its ticket, once the ring wraps the oldest samples get overwritten
+    const Uint32 ticket = (Uint32)SDL_AddAtomicInt(&m_nextTicket, 1);
+    Sample& sample = m_samples[ticket & (RingCapacity - 1)];
+    SDL_SetAtomicInt(&sample.sequence, 0);
+    sample.phase = (Uint32)a_phase;
+    sample.durationNS = durationNS;
+    sample.startNS = a_startNS;
+    sample.threadId = SDL_GetCurrentThreadID();
+    SDL_SetAtomicInt(&sample.sequence, (int)(ticket + 1));
+}
+
+ProfilePhaseStats
+Profiler::GetPhaseStats(const ProfilePhase a_phase) const
+{
+    Histogram& histogram = m_histograms[(int)a_phase];
+
+    ProfilePhaseStats stats;
+    stats.samples = (Uint32)SDL_GetAtomicInt(&histogram.samples);
+    if (stats.samples == 0)
+    {
+        return stats;
+    }
+
+    const Uint32 maxNS = SDL_GetAtomicU32(&histogram.maxNS);
+    const Uint64 p50Rank = (stats.samples + 1) / 2;
+    const Uint64 p99Rank = (stats.samples * 99 + 99) / 100;
+
+    // Each bucket stands for the middle of its range, the percentiles are never reported above the maximum
+    Uint64 counted = 0;
+    double sumNS = 0.0;
+    bool p50Found = false;
+    bool p99Found = false;
+    for (int bucket = 0; bucket < HistogramBuckets; bucket++)
+    {
+        const Uint32 count = (Uint32)SDL_GetAtomicInt(&histogram.buckets[bucket]);
+        if (count == 0)
+        {
+            continue;
+        }
+
+        const double lowerNS = bucketLowerBoundNS(bucket);
+        const double upperNS = bucket + 1 < HistogramBuckets ? bucketLowerBoundNS(bucket + 1) : (double)SDL_MAX_UINT32;
+        const double valueMS = SDL_min((lowerNS + upperNS) * 0.5, (double)maxNS) / SDL_NS_PER_MS;
+
+        counted += count;
+        sumNS += valueMS * SDL_NS_PER_MS * count;
+        if (!p50Found && counted >= p50Rank)
+        {
+            stats.p50MS = valueMS;
+            p50Found = true;
+        }
+        if (!p99Found && counted >= p99Rank)
+        {
+            stats.p99MS = valueMS;
+            p99Found = true;
+        }
+    }
+
+    stats.averageMS = sumNS / (double)counted / SDL_NS_PER_MS;
+    stats.maxMS = (double)maxNS / SDL_NS_PER_MS;
+
+    return stats;
+}
+
+const char*
+Profiler::PhaseName(const ProfilePhase a_phase)
+{
+    return PhaseNames[(int)a_phase];
+}
+
+void
+Profiler::LogSummary() const
+{
+    for (int phase = 0; phase < (int)ProfilePhase::Count; phase++)
+    {
+        const ProfilePhaseStats stats = GetPhaseStats((ProfilePhase)phase);
+        if (stats.samples == 0)
+        {
+            continue;
+        }
+
+        SDL_Log("%-16s %9llu samples, average %.4f ms, p50 %.4f ms, p99 %.4f ms, max %.4f ms",
+                PhaseName((ProfilePhase)phase),
+                (unsigned long long)stats.samples,
+                stats.averageMS,
+                stats.p50MS,
+                stats.p99MS,
+                stats.maxMS);
+    }
+}
+
+void
+Profiler::Reset()
+{
+    SDL_SetAtomicInt(&m_nextTicket, 0);
+    for (Sample& sample : m_samples)
+    {
+        SDL_SetAtomicInt(&sample.sequence, 0);
+    }
+
+    for (Histogram& histogram : m_histograms)
+    {
+        for (SDL_AtomicInt& bucket : histogram.buckets)
+        {
+            SDL_SetAtomicInt(&bucket, 0);
+        }
+        SDL_SetAtomicInt(&histogram.samples, 0);
+        SDL_SetAtomicU32(&histogram.maxNS, 0);
+    }
+}
+
+bool
+Profiler::WriteChromeTrace(const char* a_path) const
+{
+    SDL_IOStream* stream_p = SDL_IOFromFile(a_path, "w");
+    if (!stream_p)
+    {
+        SDL_Log("Couldn't open trace file %s: %s", a_path, SDL_GetError());
+        return false;
+    }
+
+    // Thread ids are mapped to small numbers, the viewers store them as doubles
+    SDL_ThreadID threadIds[MaxTraceThreads];
+    int threadCount = 0;
+
+    const Uint32 nextTicket = (Uint32)SDL_GetAtomicInt(&m_nextTicket);
+    const Uint32 sampleCount = SDL_min(nextTicket, RingCapacity);
+    Uint64 writtenCount = 0;
+
+    SDL_IOprintf(stream_p, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (Uint32 ticket = nextTicket - sampleCount; ticket != nextTicket; ticket++)
+    {
+        Sample& slot = m_samples[ticket & (RingCapacity - 1)];
+        const int sequence = (int)(ticket + 1);
+        if (SDL_GetAtomicInt(&slot.sequence) != sequence)
+        {
+            continue;
+        }
+
+        const Uint32 phase = slot.phase;
+        const Uint32 durationNS = slot.durationNS;
+        const Uint64 startNS = slot.startNS;
+        const SDL_ThreadID threadId = slot.threadId;
+        if (SDL_GetAtomicInt(&slot.sequence) != sequence || phase >= (Uint32)ProfilePhase::Count)
+        {
+            // Overwritten while it was copied
+            continue;
+        }
+
+        int threadIndex = 0;
+        while (threadIndex < threadCount && threadIds[threadIndex] != threadId)
+        {
+            threadIndex++;
+        }
+        if (threadIndex == threadCount && threadCount < MaxTraceThreads)
+        {
+            threadIds[threadCount++] = threadId;
+        }
+        threadIndex = SDL_min(threadIndex, MaxTraceThreads - 1);
+
+        SDL_IOprintf(stream_p, "%s\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                     writtenCount > 0 ? "," : "",
+                     PhaseNames[phase],
+                     (double)startNS / SDL_NS_PER_US,
+                     (double)durationNS / SDL_NS_PER_US,
+                     threadIndex + 1);
+        writtenCount++;
+    }
+    SDL_IOprintf(stream_p, "\n]}\n");
+
+    if (!SDL_CloseIO(stream_p))
+    {
+        SDL_Log("Couldn't write trace file %s: %s", a_path, SDL_GetError());
+        return false;
+    }
+
+    SDL_Log("Wrote %llu trace events to %s", (unsigned long long)writtenCount, a_path);
+    return true;
+}
+
+int
+Profiler::bucketForDuration(const Uint32 a_durationNS)
+{
+    // Durations below 4 ns get a bucket each, above that every power of two is split into four buckets
+    if (a_durationNS < 4)
+    {
+        return (int)a_durationNS;
+    }
+
+    const int highestBit = SDL_MostSignificantBitIndex32(a_durationNS);
+    const int quarter = (int)((a_durationNS >> (highestBit - 2)) & 3);
+    return highestBit * 4 - 4 + quarter;
+}
+
+Uint32
+Profiler::bucketLowerBoundNS(const int a_bucket)
+{
+    if (a_bucket < 4)
+    {
+        return (Uint32)a_bucket;
+    }
+
+    const int highestBit = a_bucket / 4 + 1;
+    const Uint32 quarter = (Uint32)(a_bucket % 4);
+    return (4 + quarter) << (highestBit - 2);
+}
+
+#endif
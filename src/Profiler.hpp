@@ -0,0 +1,116 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include <vector>
+
+// Phases of a frame that get timed, nested phases are measured inside their parents
+enum class ProfilePhase
+{
+    Frame,              // Whole frame without the pacing sleep
+    Simulation,         // Every simulation tick of the frame
+    LevelIterate,       // One LevelController::Iterate call
+    BallMovement,       // Pad and ball movement including the swept brick collisions
+    BrickCollision,     // Discrete pass over the bricks near each ball
+    BallCollision,      // Spawning and colliding the balls with each other
+    RenderLevel,        // Drawing the level into the back buffer
+    RenderBrickLayer,   // Updating and compositing the cached brick layer
+    RenderPresent,      // SDL_RenderPresent
+    Count
+};
+
+#ifdef ARKANOID_PROFILING
+
+struct ProfilePhaseStats
+{
+    Uint64 samples = 0;
+    double averageMS = 0.0;
+    double p50MS = 0.0;
+    double p99MS = 0.0;
+    double maxMS = 0.0;
+};
+
+// Collects the timings of the profiled phases from any thread without locking. Every sample goes into a
+// histogram per phase with four buckets per power of two, which keeps the percentiles within 25% at any
+// duration, and into a ring buffer of the most recent samples that is exported as a Chrome trace.
+class Profiler
+{
+public:
+    static const Uint32 RingCapacity = 1u << 16;
+    static const int HistogramBuckets = 124;
+
+    static Profiler& Instance();
+
+    Profiler();
+    virtual ~Profiler() = default;
+
+    void Record(const ProfilePhase a_phase, const Uint64 a_startNS, const Uint64 a_endNS);
+
+    ProfilePhaseStats GetPhaseStats(const ProfilePhase a_phase) const;
+    static const char* PhaseName(const ProfilePhase a_phase);
+    void LogSummary() const;
+    // Not safe while other threads record
+    void Reset();
+
+    // Writes the samples still in the ring buffer in the Chrome trace event format, which chrome://tracing
+    // and Perfetto open directly
+    bool WriteChromeTrace(const char* a_path) const;
+
+private:
+    struct Sample
+    {
+        // Ticket of the sample plus one once it is completely written, 0 while it is being written
+        SDL_AtomicInt sequence;
+        Uint32 phase;
+        Uint32 durationNS;
+        Uint64 startNS;
+        SDL_ThreadID threadId;
+    };
+
+    struct Histogram
+    {
+        SDL_AtomicInt buckets[HistogramBuckets];
+        SDL_AtomicInt samples;
+        SDL_AtomicU32 maxNS;
+    };
+
+    static int bucketForDuration(const Uint32 a_durationNS);
+    static Uint32 bucketLowerBoundNS(const int a_bucket);
+
+private:
+    // Mutable because the SDL atomics are read through non-const pointers as well
+    mutable std::vector<Sample> m_samples;
+    mutable SDL_AtomicInt m_nextTicket;
+    mutable Histogram m_histograms[(int)ProfilePhase::Count];
+};
+
+// Times its own lifetime as one sample of a phase
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const ProfilePhase a_phase)
+        : m_phase(a_phase)
+        , m_startNS(SDL_GetTicksNS())
+    {
+    }
+
+    ~ProfileScope()
+    {
+        Profiler::Instance().Record(m_phase, m_startNS, SDL_GetTicksNS());
+    }
+
+private:
+    ProfilePhase m_phase;
+    Uint64 m_startNS;
+};
+
+#define ARKANOID_PROFILE_CONCAT_INNER(a_first, a_second) a_first##a_second
+#define ARKANOID_PROFILE_CONCAT(a_first, a_second) ARKANOID_PROFILE_CONCAT_INNER(a_first, a_second)
+#define ARKANOID_PROFILE_SCOPE(a_phase) ProfileScope ARKANOID_PROFILE_CONCAT(profileScope, __LINE__)(a_phase)
+
+#else
+
+// Profiling is off, the scopes compile to nothing
+#define ARKANOID_PROFILE_SCOPE(a_phase) ((void)0)
+
+#endif
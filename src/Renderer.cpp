@@ -1,267 +1,743 @@
-#include "Renderer.hpp"
-
-#include "Constants.hpp"
-#include "gameobjects/Level.hpp"
-
-#include <sstream>
-
-namespace
-{
-    const float WindowMargin = 60.0f;
-
-    const SDL_Color ClearColor      {0, 0, 0, SDL_ALPHA_OPAQUE};
-    const SDL_Color LevelBoundsColor{255, 255, 255, 25};
-    const SDL_Color TextColor       {255, 255, 255, SDL_ALPHA_OPAQUE};
-    const SDL_Color PauseColor      {0, 0, 0, 175};
-
-    const SDL_Color PadColor        {0x84, 0xa9, 0x8c, SDL_ALPHA_OPAQUE};
-    const SDL_Color BallColor       {0xea, 0xe2, 0xb7, SDL_ALPHA_OPAQUE};
-    const SDL_Color BrickHighColor  {0xd6, 0x28, 0x28, SDL_ALPHA_OPAQUE};
-    const SDL_Color BrickNormalColor{0xf7, 0x7f, 0x00, SDL_ALPHA_OPAQUE};
-    const SDL_Color BrickLowColor   {0xfc, 0xbf, 0x49, SDL_ALPHA_OPAQUE};
-    const SDL_Color BrickSolidColor {105, 105, 105, SDL_ALPHA_OPAQUE};
-    const SDL_Color DebugColor      {255, 0, 0, SDL_ALPHA_OPAQUE};
-}
-
-SDL_AppResult
-Renderer::Init()
-{
-    if (!SDL_Init(SDL_INIT_VIDEO))
-    {
-        SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
-        return SDL_APP_FAILURE;
-    }
-
-    if (!SDL_CreateWindowAndRenderer("Arkanoid", Constants::WINDOW_WIDTH, Constants::WINDOW_HEIGHT, SDL_WINDOW_RESIZABLE, &m_window_p, &m_renderer_p))
-    {
-        SDL_Log("Couldn't create window/renderer: %s", SDL_GetError());
-        return SDL_APP_FAILURE;
-    }
-    
-    if (!SDL_SetRenderLogicalPresentation(m_renderer_p, Constants::WINDOW_WIDTH, Constants::WINDOW_HEIGHT, SDL_LOGICAL_PRESENTATION_LETTERBOX))
-    {
-        SDL_Log("Couldn't set logical presentation: %s", SDL_GetError());
-        return SDL_APP_FAILURE;
-    }
-
-    if (!SDL_SetRenderDrawBlendMode(m_renderer_p, SDL_BLENDMODE_BLEND))
-    {
-        SDL_Log("Couldn't set alpha blend mode: %s", SDL_GetError());
-        return SDL_APP_FAILURE;
-    }
-
-    // Try to maximize window so it looks better
-    SDL_MaximizeWindow(m_window_p);
-
-    return SDL_APP_CONTINUE;
-}
-
-void
-Renderer::RenderTitleScreen()
-{
-    setDrawColor(ClearColor);
-    SDL_RenderClear(m_renderer_p);
-
-    renderUiRectWithText(LevelBounds(), "Press any key to start");
-
-    SDL_RenderPresent(m_renderer_p);
-}
-
-void Renderer::RenderLevel(const Level &a_level)
-{
-    setDrawColor(ClearColor);
-    SDL_RenderClear(m_renderer_p);
-
-    setDrawColor(LevelBoundsColor);
-    SDL_RenderFillRect(m_renderer_p, &a_level.bounds);
-
-    for (const Brick& brick : a_level.bricks)
-    {
-        renderBrick(brick);
-    }
-
-    if (a_level.pad.geometry.properties.isVisible)
-    {
-        setDrawColor(PadColor);
-        SDL_RenderFillRect(m_renderer_p, &a_level.pad.geometry.rect);
-    }
-
-    if (a_level.ball.geometry.properties.isVisible)
-    {
-        renderCircle(a_level.ball.geometry.center, a_level.ball.geometry.radius, BallColor);
-    }
-
-    if (false)
-    {
-        renderBallDebugLines(a_level.ball);
-    }
-
-    if (a_level.paused)
-    {
-        setDrawColor(PauseColor);
-        SDL_RenderFillRect(m_renderer_p, &a_level.bounds);
-    }
-
-    std::stringstream s;
-    s << "Balls: " << a_level.balls << "\tScore: " << a_level.score;
-    const std::string topText = s.str();
-    const std::string bottomText = a_level.paused ? "Game paused. Press P to resume." : "P: pause, SPACE: launch ball, LEFT,RIGHT: move pad, ESC: exit";
-
-    SDL_FRect uiRect;
-    uiRect.x = 0.0f;
-    uiRect.y = 0.0f;
-    uiRect.w = Constants::WINDOW_WIDTH;
-    uiRect.h = WindowMargin;
-    renderUiRectWithText(uiRect, topText);
-    uiRect.y = Constants::WINDOW_HEIGHT - WindowMargin;
-    renderUiRectWithText(uiRect, bottomText);
-
-    SDL_RenderPresent(m_renderer_p);
-}
-
-void
-Renderer::RenderFinalScore(const bool a_levelCleared, const Uint32 a_score)
-{
-    setDrawColor(ClearColor);
-    SDL_RenderClear(m_renderer_p);
-
-    std::stringstream s;
-    if (a_levelCleared)
-    {
-        s << "You won! ";
-    }
-    else
-    {
-        s << "Game over! ";
-    }
-    s << "Final score: " << a_score;
-    renderUiRectWithText(LevelBounds(), s.str());
-
-    SDL_RenderPresent(m_renderer_p);
-}
-
-SDL_FRect
-Renderer::LevelBounds() const
-{
-    SDL_FRect levelBounds;
-    levelBounds.x = 0.0f;
-    levelBounds.y = WindowMargin;
-    levelBounds.w = Constants::WINDOW_WIDTH;
-    levelBounds.h = Constants::WINDOW_HEIGHT - WindowMargin - WindowMargin;
-
-    return levelBounds;
-}
-
-SDL_FPoint
-Renderer::WindowToLevelPosition(const SDL_FPoint &a_windowPosition) const
-{
-    int windowW, windowH;
-    SDL_GetWindowSize(m_window_p, &windowW, &windowH);
-
-    // Note: this conversion is not working correctly - need to consider that when window is resized it might
-    //       have different aspect ratio from the logical coordinates in which case the letterboxing offsets
-    //       the logical coordinates
-    SDL_FPoint levelPosition{
-        a_windowPosition.x / (float)windowW * Constants::WINDOW_WIDTH,
-        a_windowPosition.y / (float)windowH * Constants::WINDOW_HEIGHT
-    };
-
-    return levelPosition;
-}
-
-void
-Renderer::setDrawColor(const SDL_Color& a_color)
-{
-    SDL_SetRenderDrawColor(m_renderer_p, a_color.r, a_color.g, a_color.b, a_color.a);
-}
-
-void
-Renderer::renderCircle(const SDL_FPoint& a_center, const float a_radius, const SDL_Color& a_color)
-{
-    const SDL_FColor circleFColor{a_color.r / 255.0f, a_color.g / 255.0f, a_color.b / 255.0f, a_color.a / 255.0f};
-
-    SDL_Vertex points[Constants::CircleSegments * 3];
-
-    for (int i = 0; i < Constants::CircleSegments; i++)
-    {
-        float theta = (float)i / (float)Constants::CircleSegments * 2.0f * SDL_PI_F;
-        points[i*3].position.x = a_center.x + a_radius * SDL_cosf(theta);
-        points[i*3].position.y = a_center.y + a_radius * SDL_sinf(theta);
-        points[i*3].color = circleFColor;
-
-        points[i*3 + 1].position = a_center;
-        points[i*3 + 1].color = circleFColor;
-
-        const int prevIndex = (i == 0) ? (Constants::CircleSegments - 1) : i - 1;
-        points[prevIndex*3 + 2] = points[i*3];
-    }
-    SDL_RenderGeometry(m_renderer_p, nullptr, points, Constants::CircleSegments * 3, nullptr, 0);
-}
-
-void
-Renderer::renderUiRectWithText(const SDL_FRect& a_rect, const std::string& a_text)
-{
-    setDrawColor(ClearColor);
-    SDL_RenderFillRect(m_renderer_p, &a_rect);
-
-    setDrawColor(TextColor);
-    SDL_RenderDebugText(m_renderer_p, a_rect.x + WindowMargin, a_rect.y + a_rect.h / 2.0f, a_text.c_str());
-}
-
-void
-Renderer::renderBrick(const Brick& a_brick)
-{
-    if (!a_brick.geometry.properties.isVisible)
-    {
-        return;
-    }
-
-    SDL_Color brickColor;
-    switch (a_brick.kind)
-    {
-    case BrickKind::HighScore:
-        brickColor = BrickHighColor;
-        break;
-
-    case BrickKind::NormalScore:
-        brickColor = BrickNormalColor;
-        break;
-
-    case BrickKind::LowScore:
-        brickColor = BrickLowColor;
-        break;
-
-    case BrickKind::Solid:
-        brickColor = BrickSolidColor;
-        break;
-    }
-
-    setDrawColor(brickColor);
-    SDL_RenderFillRect(m_renderer_p, &a_brick.geometry.rect);
-}
-
-void
-Renderer::renderBallDebugLines(const Ball& a_ball)
-{
-    setDrawColor(DebugColor);
-
-    const SDL_FPoint ballVelocity = a_ball.geometry.properties.velocity.value_or(SDL_FPoint{0.0f, 0.0f});
-    const float velocityLength = SDL_sqrtf(ballVelocity.x * ballVelocity.x + ballVelocity.y * ballVelocity.y);
-    if (velocityLength > 0.0f)
-    {
-        SDL_FPoint velocityNormalized{
-            ballVelocity.x / velocityLength,
-            ballVelocity.y / velocityLength
-        };
-        SDL_FPoint line1Start{
-            a_ball.geometry.center.x + velocityNormalized.y * a_ball.geometry.radius,
-            a_ball.geometry.center.y + -velocityNormalized.x * a_ball.geometry.radius
-        };
-        SDL_FPoint line2Start{
-            a_ball.geometry.center.x + -velocityNormalized.y * a_ball.geometry.radius,
-            a_ball.geometry.center.y + velocityNormalized.x * a_ball.geometry.radius
-        };
-        SDL_RenderLine(m_renderer_p, line1Start.x, line1Start.y, line1Start.x + ballVelocity.x, line1Start.y + ballVelocity.y);
-        SDL_RenderLine(m_renderer_p, line2Start.x, line2Start.y, line2Start.x + ballVelocity.x, line2Start.y + ballVelocity.y);
-    }
-}
+#include "Renderer.hpp"
+
+#include "Constants.hpp"
+#include "gameobjects/BrickChangeLog.hpp"
+#include "gameobjects/Level.hpp"
+#include "gameobjects/LevelMotion.hpp"
+#include "Profiler.hpp"
+
+
+namespace
+{
+    const float WindowMargin = 60.0f;
+
+    const SDL_Color ClearColor      {0, 0, 0, SDL_ALPHA_OPAQUE};
+    const SDL_Color LevelBoundsColor{255, 255, 255, 25};
+    const SDL_Color TextColor       {255, 255, 255, SDL_ALPHA_OPAQUE};
+    const SDL_Color PauseColor      {0, 0, 0, 175};
+
+    const SDL_Color PadColor        {0x84, 0xa9, 0x8c, SDL_ALPHA_OPAQUE};
+    const SDL_Color BallColor       {0xea, 0xe2, 0xb7, SDL_ALPHA_OPAQUE};
+    const SDL_Color BrickHighColor  {0xd6, 0x28, 0x28, SDL_ALPHA_OPAQUE};
+    const SDL_Color BrickNormalColor{0xf7, 0x7f, 0x00, SDL_ALPHA_OPAQUE};
+    const SDL_Color BrickLowColor   {0xfc, 0xbf, 0x49, SDL_ALPHA_OPAQUE};
+    const SDL_Color BrickSolidColor {105, 105, 105, SDL_ALPHA_OPAQUE};
+    const SDL_Color BrickMultiBallColor{0x3a, 0x86, 0xff, SDL_ALPHA_OPAQUE};
+    const SDL_Color DebugColor      {255, 0, 0, SDL_ALPHA_OPAQUE};
+
+    const SDL_Color ProfilerOverlayColor{0, 0, 0, 200};
+    const float ProfilerOverlayMargin = 20.0f;
+
+    const char* const ControlsText = "P:pause SPACE:launch ARROWS:move BKSP:rewind R:restart ESC:exit";
+    const char* const ControlsWithoutRewindText = "P:pause SPACE:launch ARROWS:move R:restart ESC:exit";
+    const char* const PausedText = "Game paused. Press P to resume.";
+
+    SDL_FColor
+    toFColor(const SDL_Color& a_color)
+    {
+        return SDL_FColor{a_color.r / 255.0f, a_color.g / 255.0f, a_color.b / 255.0f, a_color.a / 255.0f};
+    }
+
+    SDL_Color
+    getBrickColor(const BrickKind a_kind)
+    {
+        switch (a_kind)
+        {
+        case BrickKind::HighScore:
+            return BrickHighColor;
+
+        case BrickKind::NormalScore:
+            return BrickNormalColor;
+
+        case BrickKind::LowScore:
+            return BrickLowColor;
+
+        case BrickKind::Solid:
+            return BrickSolidColor;
+
+        case BrickKind::MultiBall:
+            return BrickMultiBallColor;
+        }
+
+        return BrickSolidColor;
+    }
+
+    float
+    interpolate(const float a_from, const float a_to, const float a_alpha)
+    {
+        return a_from + (a_to - a_from) * a_alpha;
+    }
+}
+
+Renderer::Renderer()
+    : m_window_p(nullptr)
+    , m_renderer_p(nullptr)
+    , m_offscreenSurface_p(nullptr)
+    , m_brickGeometryRevision(0)
+    , m_brickGeometrySourceSize(0)
+    , m_brickGeometryValid(false)
+    , m_brickLayerTexture_p(nullptr)
+    , m_brickLayerTextureW(0)
+    , m_brickLayerTextureH(0)
+    , m_brickLayerPixelsPerUnit(0.0f)
+    , m_brickLayerBounds{0.0f, 0.0f, 0.0f, 0.0f}
+    , m_brickLayerRevision(0)
+    , m_brickLayerChanges(0)
+    , m_brickLayerChangesKnown(false)
+    , m_brickLayerValid(false)
+    , m_hudScore(0)
+    , m_hudBalls(0)
+    , m_hudScoreValid(false)
+#ifdef ARKANOID_PROFILING
+    , m_profilerOverlayVisible(false)
+#endif
+{
+    m_hudTextCache.SetText(HudLine::Controls, ControlsText);
+    m_hudTextCache.SetText(HudLine::Paused, PausedText);
+}
+
+Renderer::~Renderer()
+{
+    // Textures have to go before their renderer, a window renderer is cleaned up by SDL itself
+    ResetRenderCaches();
+
+    if (m_offscreenSurface_p)
+    {
+        SDL_DestroyRenderer(m_renderer_p);
+        SDL_DestroySurface(m_offscreenSurface_p);
+    }
+}
+
+SDL_AppResult
+Renderer::Init()
+{
+    if (!SDL_Init(SDL_INIT_VIDEO))
+    {
+        SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
+        return SDL_APP_FAILURE;
+    }
+
+    if (!SDL_CreateWindowAndRenderer("Arkanoid", Constants::WINDOW_WIDTH, Constants::WINDOW_HEIGHT, SDL_WINDOW_RESIZABLE, &m_window_p, &m_renderer_p))
+    {
+        SDL_Log("Couldn't create window/renderer: %s", SDL_GetError());
+        return SDL_APP_FAILURE;
+    }
+    
+    if (!SDL_SetRenderLogicalPresentation(m_renderer_p, Constants::WINDOW_WIDTH, Constants::WINDOW_HEIGHT, SDL_LOGICAL_PRESENTATION_LETTERBOX))
+    {
+        SDL_Log("Couldn't set logical presentation: %s", SDL_GetError());
+        return SDL_APP_FAILURE;
+    }
+
+    if (!SDL_SetRenderDrawBlendMode(m_renderer_p, SDL_BLENDMODE_BLEND))
+    {
+        SDL_Log("Couldn't set alpha blend mode: %s", SDL_GetError());
+        return SDL_APP_FAILURE;
+    }
+
+    // Try to maximize window so it looks better
+    SDL_MaximizeWindow(m_window_p);
+
+    return SDL_APP_CONTINUE;
+}
+
+SDL_AppResult
+Renderer::InitOffscreen()
+{
+    m_offscreenSurface_p = SDL_CreateSurface(Constants::WINDOW_WIDTH, Constants::WINDOW_HEIGHT, SDL_PIXELFORMAT_RGBA8888);
+    if (!m_offscreenSurface_p)
+    {
+        SDL_Log("Couldn't create off-screen surface: %s", SDL_GetError());
+        return SDL_APP_FAILURE;
+    }
+
+    m_renderer_p = SDL_CreateSoftwareRenderer(m_offscreenSurface_p);
+    if (!m_renderer_p)
+    {
+        SDL_Log("Couldn't create software renderer: %s", SDL_GetError());
+        return SDL_APP_FAILURE;
+    }
+
+    if (!SDL_SetRenderDrawBlendMode(m_renderer_p, SDL_BLENDMODE_BLEND))
+    {
+        SDL_Log("Couldn't set alpha blend mode: %s", SDL_GetError());
+        return SDL_APP_FAILURE;
+    }
+
+    return SDL_APP_CONTINUE;
+}
+
+bool
+Renderer::SetVSync(const bool a_enabled)
+{
+    if (!SDL_SetRenderVSync(m_renderer_p, a_enabled ? 1 : SDL_RENDERER_VSYNC_DISABLED))
+    {
+        SDL_Log("Couldn't %s vsync: %s", a_enabled ? "enable" : "disable", SDL_GetError());
+        return false;
+    }
+
+    return true;
+}
+
+void
+Renderer::RenderTitleScreen()
+{
+    setDrawColor(ClearColor);
+    SDL_RenderClear(m_renderer_p);
+
+    // The next level gets a fresh brick store whose revision may collide with the cached one
+    invalidateBrickGeometry();
+
+    renderUiRectWithText(LevelBounds(), "Press any key to start");
+
+    present();
+}
+
+void Renderer::RenderLevel(const Level &a_level, const BrickChangeLog* a_brickChanges_p)
+{
+    {
+        ARKANOID_PROFILE_SCOPE(ProfilePhase::RenderLevel);
+        drawLevel(a_level, nullptr, 1.0f, a_brickChanges_p);
+    }
+
+    present();
+}
+
+void
+Renderer::RenderLevel(const Level& a_level, const LevelMotion& a_motion, const float a_alpha, const BrickChangeLog* a_brickChanges_p)
+{
+    {
+        ARKANOID_PROFILE_SCOPE(ProfilePhase::RenderLevel);
+        drawLevel(a_level, &a_motion, a_alpha, a_brickChanges_p);
+    }
+
+    present();
+}
+
+void
+Renderer::drawLevel(const Level& a_level, const LevelMotion* a_motion_p, const float a_alpha, const BrickChangeLog* a_brickChanges_p)
+{
+    setDrawColor(ClearColor);
+    SDL_RenderClear(m_renderer_p);
+
+    const float pixelsPerUnit = getPixelsPerUnit();
+    renderBrickLayer(a_level, a_brickChanges_p, pixelsPerUnit);
+
+    if (a_level.pad.geometry.properties.isVisible)
+    {
+        SDL_FRect padRect = a_level.pad.geometry.rect;
+        if (a_motion_p)
+        {
+            padRect.x = interpolate(a_motion_p->previousPadPosition.x, padRect.x, a_alpha);
+            padRect.y = interpolate(a_motion_p->previousPadPosition.y, padRect.y, a_alpha);
+        }
+        setDrawColor(PadColor);
+        SDL_RenderFillRect(m_renderer_p, &padRect);
+    }
+
+    m_circleMeshCache.Clear(pixelsPerUnit);
+    const SDL_FColor ballFColor = toFColor(BallColor);
+    const bool interpolateBalls = a_motion_p && a_motion_p->previousBallCenters.size() == a_level.ballsInPlay.size();
+    for (size_t i = 0; i < a_level.ballsInPlay.size(); i++)
+    {
+        const CircleGeometry& ball = a_level.ballsInPlay[i].geometry;
+        if (!ball.properties.isVisible)
+        {
+            continue;
+        }
+
+        SDL_FPoint center = ball.center;
+        if (interpolateBalls)
+        {
+            center.x = interpolate(a_motion_p->previousBallCenters[i].x, center.x, a_alpha);
+            center.y = interpolate(a_motion_p->previousBallCenters[i].y, center.y, a_alpha);
+        }
+        m_circleMeshCache.Add(center, ball.radius, ballFColor);
+    }
+    renderCircles();
+
+    for (const Ball& ball : a_level.ballsInPlay)
+    {
+        if (false)
+        {
+            renderBallDebugLines(ball);
+        }
+    }
+
+    if (a_level.paused)
+    {
+        setDrawColor(PauseColor);
+        SDL_RenderFillRect(m_renderer_p, &a_level.bounds);
+    }
+
+    if (!m_hudScoreValid || m_hudScore != a_level.score || m_hudBalls != a_level.balls)
+    {
+        char scoreText[HudTextCache::MaxTextLength];
+        SDL_snprintf(scoreText, sizeof(scoreText), "Balls: %d\tScore: %u", a_level.balls, a_level.score);
+        m_hudTextCache.SetText(HudLine::Score, scoreText);
+        m_hudScore = a_level.score;
+        m_hudBalls = a_level.balls;
+        m_hudScoreValid = true;
+    }
+
+    SDL_FRect uiRect;
+    uiRect.x = 0.0f;
+    uiRect.y = 0.0f;
+    uiRect.w = Constants::WINDOW_WIDTH;
+    uiRect.h = WindowMargin;
+    renderUiRectWithHudLine(uiRect, HudLine::Score, pixelsPerUnit);
+    uiRect.y = Constants::WINDOW_HEIGHT - WindowMargin;
+    renderUiRectWithHudLine(uiRect, a_level.paused ? HudLine::Paused : HudLine::Controls, pixelsPerUnit);
+}
+
+void
+Renderer::RenderFinalScore(const bool a_levelCleared, const Uint32 a_score)
+{
+    setDrawColor(ClearColor);
+    SDL_RenderClear(m_renderer_p);
+
+    invalidateBrickGeometry();
+
+    char text[HudTextCache::MaxTextLength];
+    SDL_snprintf(text, sizeof(text), "%s Final score: %u. Press R to play again.", a_levelCleared ? "You won!" : "Game over!", a_score);
+    renderUiRectWithText(LevelBounds(), text);
+
+    present();
+}
+
+void
+Renderer::SetRewindAvailable(const bool a_available)
+{
+    m_hudTextCache.SetText(HudLine::Controls, a_available ? ControlsText : ControlsWithoutRewindText);
+}
+
+SDL_FRect
+Renderer::LevelBounds() const
+{
+    SDL_FRect levelBounds;
+    levelBounds.x = 0.0f;
+    levelBounds.y = WindowMargin;
+    levelBounds.w = Constants::WINDOW_WIDTH;
+    levelBounds.h = Constants::WINDOW_HEIGHT - WindowMargin - WindowMargin;
+
+    return levelBounds;
+}
+
+float
+Renderer::DisplayRefreshRate() const
+{
+    const SDL_DisplayID displayId = m_window_p ? SDL_GetDisplayForWindow(m_window_p) : 0;
+    const SDL_DisplayMode* displayMode_p = displayId ? SDL_GetCurrentDisplayMode(displayId) : nullptr;
+    return displayMode_p ? displayMode_p->refresh_rate : 0.0f;
+}
+
+SDL_FPoint
+Renderer::WindowToLevelPosition(const SDL_FPoint &a_windowPosition) const
+{
+    int windowW, windowH;
+    SDL_GetWindowSize(m_window_p, &windowW, &windowH);
+
+    // Note: this conversion is not working correctly - need to consider that when window is resized it might
+    //       have different aspect ratio from the logical coordinates in which case the letterboxing offsets
+    //       the logical coordinates
+    SDL_FPoint levelPosition{
+        a_windowPosition.x / (float)windowW * Constants::WINDOW_WIDTH,
+        a_windowPosition.y / (float)windowH * Constants::WINDOW_HEIGHT
+    };
+
+    return levelPosition;
+}
+
+void
+Renderer::ResetRenderCaches()
+{
+    if (m_brickLayerTexture_p)
+    {
+        SDL_DestroyTexture(m_brickLayerTexture_p);
+        m_brickLayerTexture_p = nullptr;
+    }
+    invalidateBrickGeometry();
+    m_hudTextCache.Reset();
+}
+
+const BrickLayerCacheStats&
+Renderer::GetBrickLayerCacheStats() const
+{
+    return m_brickLayerStats;
+}
+
+#ifdef ARKANOID_PROFILING
+void
+Renderer::SetProfilerOverlayVisible(const bool a_visible)
+{
+    m_profilerOverlayVisible = a_visible;
+}
+
+bool
+Renderer::ProfilerOverlayVisible() const
+{
+    return m_profilerOverlayVisible;
+}
+#endif
+
+void
+Renderer::present()
+{
+#ifdef ARKANOID_PROFILING
+    if (m_profilerOverlayVisible)
+    {
+        renderProfilerOverlay();
+    }
+#endif
+
+    ARKANOID_PROFILE_SCOPE(ProfilePhase::RenderPresent);
+    SDL_RenderPresent(m_renderer_p);
+}
+
+void
+Renderer::setDrawColor(const SDL_Color& a_color)
+{
+    SDL_SetRenderDrawColor(m_renderer_p, a_color.r, a_color.g, a_color.b, a_color.a);
+}
+
+void
+Renderer::renderCircles()
+{
+    if (!m_circleMeshCache.Empty())
+    {
+        SDL_RenderGeometry(m_renderer_p, nullptr,
+                           m_circleMeshCache.Vertices(), m_circleMeshCache.VertexCount(),
+                           m_circleMeshCache.Indices(), m_circleMeshCache.IndexCount());
+    }
+}
+
+float
+Renderer::getPixelsPerUnit() const
+{
+    // Logical coordinates are letterboxed into this rect, so its width gives the scale to the window pixels
+    SDL_FRect outputRect;
+    if (m_renderer_p && SDL_GetRenderLogicalPresentationRect(m_renderer_p, &outputRect) && outputRect.w > 0.0f)
+    {
+        return outputRect.w / Constants::WINDOW_WIDTH;
+    }
+
+    return 1.0f;
+}
+
+void
+Renderer::renderUiRectWithText(const SDL_FRect& a_rect, const char* a_text)
+{
+    setDrawColor(ClearColor);
+    SDL_RenderFillRect(m_renderer_p, &a_rect);
+
+    setDrawColor(TextColor);
+    SDL_RenderDebugText(m_renderer_p, a_rect.x + WindowMargin, a_rect.y + a_rect.h / 2.0f, a_text);
+}
+
+void
+Renderer::renderUiRectWithHudLine(const SDL_FRect& a_rect, const HudLine a_line, const float a_pixelsPerUnit)
+{
+    setDrawColor(ClearColor);
+    SDL_RenderFillRect(m_renderer_p, &a_rect);
+
+    const SDL_FPoint textPosition{a_rect.x + WindowMargin, a_rect.y + a_rect.h / 2.0f};
+    m_hudTextCache.Render(m_renderer_p, a_line, textPosition, TextColor, a_pixelsPerUnit);
+}
+
+void
+Renderer::renderBricks(const BrickStore& a_bricks)
+{
+    if (!m_brickGeometryValid || m_brickGeometryRevision != a_bricks.revision || m_brickGeometrySourceSize != a_bricks.Size())
+    {
+        rebuildBrickGeometry(a_bricks);
+    }
+
+    if (!m_brickVertices.empty())
+    {
+        SDL_RenderGeometry(m_renderer_p, nullptr,
+                           m_brickVertices.data(), (int)m_brickVertices.size(),
+                           m_brickIndices.data(), (int)(m_brickVertices.size() / 4 * 6));
+    }
+}
+
+void
+Renderer::rebuildBrickGeometry(const BrickStore& a_bricks)
+{
+    m_brickVertices.clear();
+    m_brickVertices.reserve(a_bricks.aliveCount * 4);
+
+    for (size_t brickIndex = 0; brickIndex < a_bricks.Size(); brickIndex++)
+    {
+        if (!a_bricks.IsAlive(brickIndex))
+        {
+            continue;
+        }
+
+        const SDL_FRect rect = a_bricks.Rect(brickIndex);
+        const SDL_FColor color = toFColor(getBrickColor(a_bricks.kind[brickIndex]));
+        const SDL_FPoint noTexture{0.0f, 0.0f};
+
+        m_brickVertices.push_back({{rect.x, rect.y}, color, noTexture});
+        m_brickVertices.push_back({{rect.x + rect.w, rect.y}, color, noTexture});
+        m_brickVertices.push_back({{rect.x + rect.w, rect.y + rect.h}, color, noTexture});
+        m_brickVertices.push_back({{rect.x, rect.y + rect.h}, color, noTexture});
+    }
+
+    // The index pattern is the same for every quad, so it only has to grow with the largest brick count seen
+    const size_t quadCount = m_brickVertices.size() / 4;
+    for (size_t quad = m_brickIndices.size() / 6; quad < quadCount; quad++)
+    {
+        const int first = (int)(quad * 4);
+        const int quadIndices[6] = {first, first + 1, first + 2, first, first + 2, first + 3};
+        m_brickIndices.insert(m_brickIndices.end(), quadIndices, quadIndices + 6);
+    }
+
+    m_brickGeometryRevision = a_bricks.revision;
+    m_brickGeometrySourceSize = a_bricks.Size();
+    m_brickGeometryValid = true;
+}
+
+void
+Renderer::invalidateBrickGeometry()
+{
+    m_brickGeometryValid = false;
+    m_brickLayerValid = false;
+}
+
+void
+Renderer::renderBrickLayer(const Level& a_level, const BrickChangeLog* a_brickChanges_p, const float a_pixelsPerUnit)
+{
+    ARKANOID_PROFILE_SCOPE(ProfilePhase::RenderBrickLayer);
+
+    m_brickLayerStats.bricksDrawnLastFrame = 0;
+
+    if (!prepareBrickLayerTexture(a_level.bounds, a_pixelsPerUnit))
+    {
+        // No render target, draw the layer straight to the window every frame
+        setDrawColor(LevelBoundsColor);
+        SDL_RenderFillRect(m_renderer_p, &a_level.bounds);
+        renderBricks(a_level.bricks);
+
+        m_brickLayerStats.misses++;
+        m_brickLayerStats.bricksDrawnLastFrame = (Uint32)a_level.bricks.aliveCount;
+        return;
+    }
+
+    const bool sameLayout = m_brickLayerValid && m_brickLayerAlive.size() == a_level.bricks.Size();
+    if (sameLayout && m_brickLayerRevision == a_level.bricks.revision)
+    {
+        m_brickLayerStats.hits++;
+    }
+    else if (sameLayout && redrawDestroyedBricks(a_level, a_brickChanges_p))
+    {
+        m_brickLayerStats.partialUpdates++;
+    }
+    else
+    {
+        redrawBrickLayer(a_level, a_brickChanges_p);
+        m_brickLayerStats.misses++;
+    }
+
+    const SDL_FRect sourceRect{a_level.bounds.x * m_brickLayerPixelsPerUnit,
+                               a_level.bounds.y * m_brickLayerPixelsPerUnit,
+                               a_level.bounds.w * m_brickLayerPixelsPerUnit,
+                               a_level.bounds.h * m_brickLayerPixelsPerUnit};
+    SDL_RenderTexture(m_renderer_p, m_brickLayerTexture_p, &sourceRect, &a_level.bounds);
+}
+
+bool
+Renderer::prepareBrickLayerTexture(const SDL_FRect& a_levelBounds, const float a_pixelsPerUnit)
+{
+    // The texture spans the window from its origin to the far corner of the level, so the level can be
+    // drawn into it with the same coordinates as into the window
+    const int textureW = (int)SDL_ceilf((a_levelBounds.x + a_levelBounds.w) * a_pixelsPerUnit);
+    const int textureH = (int)SDL_ceilf((a_levelBounds.y + a_levelBounds.h) * a_pixelsPerUnit);
+
+    if (m_brickLayerTexture_p &&
+        textureW == m_brickLayerTextureW &&
+        textureH == m_brickLayerTextureH &&
+        a_pixelsPerUnit == m_brickLayerPixelsPerUnit)
+    {
+        return true;
+    }
+
+    if (m_brickLayerTexture_p)
+    {
+        SDL_DestroyTexture(m_brickLayerTexture_p);
+    }
+
+    m_brickLayerTexture_p = SDL_CreateTexture(m_renderer_p, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, textureW, textureH);
+    m_brickLayerValid = false;
+    if (!m_brickLayerTexture_p)
+    {
+        SDL_Log("Couldn't create brick layer texture: %s", SDL_GetError());
+        m_brickLayerTextureW = 0;
+        m_brickLayerTextureH = 0;
+        return false;
+    }
+
+    // The layer is opaque, it replaces the level area of the window instead of blending over it
+    SDL_SetTextureBlendMode(m_brickLayerTexture_p, SDL_BLENDMODE_NONE);
+    SDL_SetTextureScaleMode(m_brickLayerTexture_p, SDL_SCALEMODE_NEAREST);
+    m_brickLayerTextureW = textureW;
+    m_brickLayerTextureH = textureH;
+    m_brickLayerPixelsPerUnit = a_pixelsPerUnit;
+
+    return true;
+}
+
+void
+Renderer::redrawBrickLayer(const Level& a_level, const BrickChangeLog* a_brickChanges_p)
+{
+    beginBrickLayerDrawing();
+
+    setDrawColor(ClearColor);
+    SDL_RenderClear(m_renderer_p);
+    setDrawColor(LevelBoundsColor);
+    SDL_RenderFillRect(m_renderer_p, &a_level.bounds);
+    renderBricks(a_level.bricks);
+
+    endBrickLayerDrawing();
+
+    m_brickLayerAlive.assign(a_level.bricks.alive.begin(), a_level.bricks.alive.end());
+    m_brickLayerRevision = a_level.bricks.revision;
+    m_brickLayerChangesKnown = a_brickChanges_p != nullptr;
+    m_brickLayerChanges = a_brickChanges_p ? a_brickChanges_p->End() : 0;
+    m_brickLayerBounds = a_level.bounds;
+    m_brickLayerValid = true;
+    m_brickLayerStats.bricksDrawnLastFrame = (Uint32)a_level.bricks.aliveCount;
+}
+
+bool
+Renderer::redrawDestroyedBricks(const Level& a_level, const BrickChangeLog* a_brickChanges_p)
+{
+    const BrickStore& bricks = a_level.bricks;
+
+    // Bricks only ever get destroyed during a level and the log restarts when they come back, on a
+    // restart or a rewind. A layer from before the start of the log needs a full redraw.
+    if (!a_brickChanges_p || !m_brickLayerChangesKnown || !a_brickChanges_p->Covers(m_brickLayerChanges))
+    {
+        return false;
+    }
+
+    if (SDL_memcmp(&m_brickLayerBounds, &a_level.bounds, sizeof(SDL_FRect)) != 0)
+    {
+        return false;
+    }
+
+    beginBrickLayerDrawing();
+
+    const std::vector<Uint32>& changedBricks = a_brickChanges_p->bricks;
+    for (size_t i = (size_t)(m_brickLayerChanges - a_brickChanges_p->start); i < changedBricks.size(); i++)
+    {
+        const Uint32 brickIndex = changedBricks[i];
+        if (bricks.alive[brickIndex] || !m_brickLayerAlive[brickIndex])
+        {
+            continue;
+        }
+
+        // Replace the brick with the background, then restore whatever alive brick shares the region
+        const SDL_FRect rect = bricks.Rect(brickIndex);
+        SDL_SetRenderDrawBlendMode(m_renderer_p, SDL_BLENDMODE_NONE);
+        setDrawColor(ClearColor);
+        SDL_RenderFillRect(m_renderer_p, &rect);
+        SDL_SetRenderDrawBlendMode(m_renderer_p, SDL_BLENDMODE_BLEND);
+        setDrawColor(LevelBoundsColor);
+        SDL_RenderFillRect(m_renderer_p, &rect);
+
+        a_level.brickGrid.Query(rect, m_brickLayerCandidates);
+        for (const Uint32 candidate : m_brickLayerCandidates)
+        {
+            const SDL_FRect candidateRect = bricks.Rect(candidate);
+            setDrawColor(getBrickColor(bricks.kind[candidate]));
+            SDL_RenderFillRect(m_renderer_p, &candidateRect);
+            m_brickLayerStats.bricksDrawnLastFrame++;
+        }
+
+        m_brickLayerAlive[brickIndex] = 0;
+        m_brickLayerStats.dirtyRegions++;
+    }
+
+    endBrickLayerDrawing();
+
+    m_brickLayerRevision = bricks.revision;
+    m_brickLayerChanges = a_brickChanges_p->End();
+    return true;
+}
+
+void
+Renderer::beginBrickLayerDrawing()
+{
+    SDL_SetRenderTarget(m_renderer_p, m_brickLayerTexture_p);
+    SDL_SetRenderScale(m_renderer_p, m_brickLayerPixelsPerUnit, m_brickLayerPixelsPerUnit);
+}
+
+void
+Renderer::endBrickLayerDrawing()
+{
+    SDL_SetRenderScale(m_renderer_p, 1.0f, 1.0f);
+    SDL_SetRenderTarget(m_renderer_p, nullptr);
+}
+
+#ifdef ARKANOID_PROFILING
+void
+Renderer::renderProfilerOverlay()
+{
+    const float lineHeight = SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE * 1.5f;
+    const SDL_FRect overlayRect{
+        ProfilerOverlayMargin,
+        WindowMargin + ProfilerOverlayMargin,
+        Constants::WINDOW_WIDTH - ProfilerOverlayMargin * 2.0f,
+        lineHeight * ((int)ProfilePhase::Count + 1) + ProfilerOverlayMargin
+    };
+    setDrawColor(ProfilerOverlayColor);
+    SDL_RenderFillRect(m_renderer_p, &overlayRect);
+
+    const float textX = overlayRect.x + ProfilerOverlayMargin / 2.0f;
+    float textY = overlayRect.y + ProfilerOverlayMargin / 2.0f;
+    setDrawColor(TextColor);
+    SDL_RenderDebugText(m_renderer_p, textX, textY, "Phase                 samples   avg ms   p50 ms   p99 ms   max ms");
+
+    // Formatted into a stack buffer, the overlay should not disturb what it measures by allocating
+    char line[HudTextCache::MaxTextLength];
+    for (int phase = 0; phase < (int)ProfilePhase::Count; phase++)
+    {
+        const ProfilePhaseStats stats = Profiler::Instance().GetPhaseStats((ProfilePhase)phase);
+        SDL_snprintf(line, sizeof(line), "%-18s %10llu %8.3f %8.3f %8.3f %8.3f",
+                     Profiler::PhaseName((ProfilePhase)phase),
+                     (unsigned long long)stats.samples,
+                     stats.averageMS,
+                     stats.p50MS,
+                     stats.p99MS,
+                     stats.maxMS);
+        textY += lineHeight;
+        SDL_RenderDebugText(m_renderer_p, textX, textY, line);
+    }
+}
+#endif
+
+void
+Renderer::renderBallDebugLines(const Ball& a_ball)
+{
+    setDrawColor(DebugColor);
+
+    const SDL_FPoint ballVelocity = a_ball.geometry.properties.velocity.value_or(SDL_FPoint{0.0f, 0.0f});
+    const float velocityLength = SDL_sqrtf(ballVelocity.x * ballVelocity.x + ballVelocity.y * ballVelocity.y);
+    if (velocityLength > 0.0f)
+    {
+        SDL_FPoint velocityNormalized{
+            ballVelocity.x / velocityLength,
+            ballVelocity.y / velocityLength
+        };
+        SDL_FPoint line1Start{
+            a_ball.geometry.center.x + velocityNormalized.y * a_ball.geometry.radius,
+            a_ball.geometry.center.y + -velocityNormalized.x * a_ball.geometry.radius
+        };
+        SDL_FPoint line2Start{
+            a_ball.geometry.center.x + -velocityNormalized.y * a_ball.geometry.radius,
+            a_ball.geometry.center.y + velocityNormalized.x * a_ball.geometry.radius
+        };
+        SDL_RenderLine(m_renderer_p, line1Start.x, line1Start.y, line1Start.x + ballVelocity.x, line1Start.y + ballVelocity.y);
+        SDL_RenderLine(m_renderer_p, line2Start.x, line2Start.y, line2Start.x + ballVelocity.x, line2Start.y + ballVelocity.y);
+    }
+}
@@ -1,34 +1,130 @@
-#pragma once
-
-#include <SDL3/SDL.h>
-
-#include <memory>
-
-struct Ball;
-struct Brick;
-struct Level;
-
-class Renderer {
-public:
-    virtual ~Renderer() = default;
-
-    SDL_AppResult Init();
-
-    void RenderTitleScreen();
-    void RenderLevel(const Level& a_level);
-    void RenderFinalScore(const bool a_levelCleared, const Uint32 a_score);
-    
-    SDL_FRect LevelBounds() const;
-    SDL_FPoint WindowToLevelPosition(const SDL_FPoint& a_windowPosition) const;
-
-private:
-    void setDrawColor(const SDL_Color& a_color);
-    void renderCircle(const SDL_FPoint& a_center, const float a_radius, const SDL_Color& a_color);
-    void renderUiRectWithText(const SDL_FRect& a_rect, const std::string& a_text);
-    void renderBrick(const Brick& a_brick);
-    void renderBallDebugLines(const Ball& a_ball);
-
-private:
-    SDL_Window* m_window_p;
-    SDL_Renderer* m_renderer_p;
+#pragma once
+
+#include "CircleMeshCache.hpp"
+#include "HudTextCache.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <memory>
+#include <vector>
+
+struct Ball;
+struct BrickChangeLog;
+enum class BrickKind;
+struct BrickStore;
+struct Level;
+struct LevelMotion;
+
+// Counters of the cached brick layer, a steady frame is a hit and draws no bricks at all
+struct BrickLayerCacheStats
+{
+    Uint64 hits = 0;            // Frames that only composited the cached layer
+    Uint64 partialUpdates = 0;  // Frames that redrew the regions of destroyed bricks
+    Uint64 dirtyRegions = 0;    // Regions redrawn by the partial updates
+    Uint64 misses = 0;          // Frames that redrew the whole layer
+    Uint32 bricksDrawnLastFrame = 0;
+};
+
+class Renderer {
+public:
+    Renderer();
+    virtual ~Renderer();
+
+    SDL_AppResult Init();
+    // Renders into an off-screen surface with the software renderer instead of opening a window
+    SDL_AppResult InitOffscreen();
+
+    // Makes presenting wait for the display refresh, returns false when the renderer does not support it
+    bool SetVSync(const bool a_enabled);
+
+    void RenderTitleScreen();
+    // a_brickChanges_p lists the bricks hit up to the state of a_level, with it only the regions of the
+    // destroyed bricks are drawn again, without it every brick change redraws the whole layer
+    void RenderLevel(const Level& a_level, const BrickChangeLog* a_brickChanges_p = nullptr);
+    // Draws the pad and the balls a_alpha of the way from their positions before the last simulation step
+    // to the current ones
+    void RenderLevel(const Level& a_level, const LevelMotion& a_motion, const float a_alpha, const BrickChangeLog* a_brickChanges_p = nullptr);
+    void RenderFinalScore(const bool a_levelCleared, const Uint32 a_score);
+    // The controls line only lists rewinding while it is available
+    void SetRewindAvailable(const bool a_available);
+    
+    SDL_FRect LevelBounds() const;
+    // Refresh rate of the display the window is on, 0 when it is unknown
+    float DisplayRefreshRate() const;
+    SDL_FPoint WindowToLevelPosition(const SDL_FPoint& a_windowPosition) const;
+
+    // Drops every cached texture and buffer, needed when the render targets or the device were reset
+    void ResetRenderCaches();
+    const BrickLayerCacheStats& GetBrickLayerCacheStats() const;
+
+#ifdef ARKANOID_PROFILING
+    // Draws the per-phase timings of the profiler over every screen
+    void SetProfilerOverlayVisible(const bool a_visible);
+    bool ProfilerOverlayVisible() const;
+#endif
+
+private:
+    void drawLevel(const Level& a_level, const LevelMotion* a_motion_p, const float a_alpha, const BrickChangeLog* a_brickChanges_p);
+    void present();
+    void setDrawColor(const SDL_Color& a_color);
+    void renderCircles();
+    float getPixelsPerUnit() const;
+    void renderUiRectWithText(const SDL_FRect& a_rect, const char* a_text);
+    void renderUiRectWithHudLine(const SDL_FRect& a_rect, const HudLine a_line, const float a_pixelsPerUnit);
+    void renderBricks(const BrickStore& a_bricks);
+    void rebuildBrickGeometry(const BrickStore& a_bricks);
+    void invalidateBrickGeometry();
+    void renderBrickLayer(const Level& a_level, const BrickChangeLog* a_brickChanges_p, const float a_pixelsPerUnit);
+    bool prepareBrickLayerTexture(const SDL_FRect& a_levelBounds, const float a_pixelsPerUnit);
+    void redrawBrickLayer(const Level& a_level, const BrickChangeLog* a_brickChanges_p);
+    bool redrawDestroyedBricks(const Level& a_level, const BrickChangeLog* a_brickChanges_p);
+    void beginBrickLayerDrawing();
+    void endBrickLayerDrawing();
+    void renderBallDebugLines(const Ball& a_ball);
+#ifdef ARKANOID_PROFILING
+    void renderProfilerOverlay();
+#endif
+
+private:
+    SDL_Window* m_window_p;
+    SDL_Renderer* m_renderer_p;
+    SDL_Surface* m_offscreenSurface_p;
+
+    // All alive bricks as one indexed quad list, drawn with a single SDL_RenderGeometry call. Rebuilt only
+    // when the brick store revision changes, the buffers keep their capacity between rebuilds.
+    std::vector<SDL_Vertex> m_brickVertices;
+    std::vector<int> m_brickIndices;
+    Uint64 m_brickGeometryRevision;
+    size_t m_brickGeometrySourceSize;
+    bool m_brickGeometryValid;
+
+    // Level background with the bricks, rendered at window pixel resolution and composited with one copy.
+    // m_brickLayerChanges is the position in the simulation's log of hit bricks the texture is current up
+    // to, only the bricks logged after it are looked at and the destroyed ones have their regions redrawn.
+    // m_brickLayerAlive is the alive state the texture shows, a brick hit again after it was cleared is
+    // not redrawn twice.
+    SDL_Texture* m_brickLayerTexture_p;
+    int m_brickLayerTextureW;
+    int m_brickLayerTextureH;
+    float m_brickLayerPixelsPerUnit;
+    SDL_FRect m_brickLayerBounds;
+    std::vector<Uint8> m_brickLayerAlive;
+    Uint64 m_brickLayerRevision;
+    Uint64 m_brickLayerChanges;
+    bool m_brickLayerChangesKnown;
+    bool m_brickLayerValid;
+    std::vector<Uint32> m_brickLayerCandidates;
+    BrickLayerCacheStats m_brickLayerStats;
+
+    CircleMeshCache m_circleMeshCache;
+
+    // The score line is only formatted again when the score or the ball count changes
+    HudTextCache m_hudTextCache;
+    Uint32 m_hudScore;
+    int m_hudBalls;
+    bool m_hudScoreValid;
+
+#ifdef ARKANOID_PROFILING
+    bool m_profilerOverlayVisible;
+#endif
 };
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+// Binary replay file layout. All values are little-endian and every section is naturally aligned,
+// so a memory-mapped file is used in place:
+//   ReplayHeader
+//   ReplayEvent[eventCount]      sorted by tick
+//   Uint64[tickCount]            state hash after each tick, starting at hashesOffset
+namespace ReplayFormat
+{
+    const Uint32 Magic = SDL_FOURCC('A', 'R', 'K', 'R');
+    const Uint16 Version = 1;
+
+    enum class EventType : Uint8
+    {
+        KeyDown,
+        KeyUp,
+        MouseButtonDown,
+        MouseButtonUp
+    };
+}
+
+struct ReplayHeader
+{
+    Uint32 magic;
+    Uint16 version;
+    Uint16 headerSize;
+    Uint64 randomSeed;
+    SDL_FRect levelBounds;
+    Uint32 tickRateHz;
+    Uint32 extraBalls;
+    Uint32 eventCount;
+    Uint32 reserved;
+    Uint64 tickCount;
+    Uint64 hashesOffset;
+};
+
+// Input applied right before the simulation tick with the given index
+struct ReplayEvent
+{
+    Uint32 tick;
+    ReplayFormat::EventType type;
+    Uint8 mouseButton;
+    Uint16 reserved;
+    SDL_Keycode key;
+    SDL_FPoint levelPosition;
+};
+
+static_assert(sizeof(ReplayHeader) == 64, "Replay header layout changed");
+static_assert(sizeof(ReplayEvent) == 20, "Replay event layout changed");
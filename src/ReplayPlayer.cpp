@@ -0,0 +1,149 @@
+#include "ReplayPlayer.hpp"
+
+#include "GeometryEngine.hpp"
+#include "LevelController.hpp"
+#include "LevelFactory.hpp"
+#include "SimulationClock.hpp"
+
+ReplayPlayer::ReplayPlayer(std::shared_ptr<LevelFactory> a_levelFactory_sp,
+                           std::shared_ptr<GeometryEngine> a_geometryEngine_sp)
+    : m_levelFactory_sp(a_levelFactory_sp)
+    , m_geometryEngine_sp(a_geometryEngine_sp)
+    , m_header_p(nullptr)
+    , m_events_p(nullptr)
+    , m_stateHashes_p(nullptr)
+    , m_levelController(a_geometryEngine_sp, Level())
+{
+}
+
+bool
+ReplayPlayer::Load(const char* a_path)
+{
+    m_header_p = nullptr;
+    m_events_p = nullptr;
+    m_stateHashes_p = nullptr;
+
+    if (!m_file.Open(a_path))
+    {
+        return false;
+    }
+
+    // The event and hash arrays are used straight from the mapping, only their bounds and order are checked
+    const ReplayHeader* header_p = (const ReplayHeader*)m_file.Data();
+    if (m_file.Size() < sizeof(ReplayHeader) ||
+        header_p->magic != ReplayFormat::Magic ||
+        header_p->version != ReplayFormat::Version ||
+        header_p->headerSize != sizeof(ReplayHeader))
+    {
+        SDL_Log("%s is not a supported replay file", a_path);
+        return false;
+    }
+
+    const Uint64 eventsEnd = sizeof(ReplayHeader) + (Uint64)header_p->eventCount * sizeof(ReplayEvent);
+    if (eventsEnd > header_p->hashesOffset ||
+        header_p->hashesOffset % sizeof(Uint64) != 0 ||
+        header_p->hashesOffset + header_p->tickCount * sizeof(Uint64) > m_file.Size())
+    {
+        SDL_Log("Replay file %s is truncated or corrupt", a_path);
+        return false;
+    }
+
+    // Play walks the events along with the ticks, one out of order would be skipped without notice
+    const ReplayEvent* events_p = (const ReplayEvent*)(m_file.Data() + sizeof(ReplayHeader));
+    for (Uint32 i = 1; i < header_p->eventCount; i++)
+    {
+        if (events_p[i].tick < events_p[i - 1].tick)
+        {
+            SDL_Log("Replay file %s has event %u at tick %u after tick %u, events have to be sorted by tick",
+                    a_path, i, events_p[i].tick, events_p[i - 1].tick);
+            return false;
+        }
+    }
+
+    m_header_p = header_p;
+    m_events_p = events_p;
+    m_stateHashes_p = (const Uint64*)(m_file.Data() + header_p->hashesOffset);
+    m_levelFactory_sp->CreateLevel(header_p->levelBounds, m_startLevel);
+
+    return true;
+}
+
+const ReplayHeader&
+ReplayPlayer::Header() const
+{
+    return *m_header_p;
+}
+
+ReplayResult
+ReplayPlayer::Play()
+{
+    ReplayResult result;
+    if (!m_header_p)
+    {
+        return result;
+    }
+
+    LevelController& levelController = m_levelController;
+    levelController.Reset(m_startLevel);
+    levelController.SetRandomSeed(m_header_p->randomSeed);
+    levelController.SpawnBalls((int)m_header_p->extraBalls);
+
+    // Tick length has to come from the same clock the recording used to get bit-identical steps
+    const float tickSeconds = SimulationClock(m_header_p->tickRateHz, 1).TickSeconds();
+
+    result.stateMatched = true;
+    Uint32 eventIndex = 0;
+    for (Uint64 tick = 0; tick < m_header_p->tickCount; tick++)
+    {
+        while (eventIndex < m_header_p->eventCount && m_events_p[eventIndex].tick == tick)
+        {
+            applyEvent(levelController, m_events_p[eventIndex]);
+            eventIndex++;
+        }
+
+        levelController.Iterate(tickSeconds);
+        result.ticks++;
+
+        if (levelController.StateHash() != m_stateHashes_p[tick])
+        {
+            result.stateMatched = false;
+            result.firstMismatchTick = tick;
+            break;
+        }
+    }
+
+    result.score = levelController.GetLevel().score;
+
+    return result;
+}
+
+void
+ReplayPlayer::applyEvent(LevelController& a_levelController, const ReplayEvent& a_event) const
+{
+    switch (a_event.type)
+    {
+        case ReplayFormat::EventType::KeyDown:
+        case ReplayFormat::EventType::KeyUp:
+        {
+            SDL_KeyboardEvent keyEvent;
+            SDL_zero(keyEvent);
+            keyEvent.type = a_event.type == ReplayFormat::EventType::KeyDown ? SDL_EVENT_KEY_DOWN : SDL_EVENT_KEY_UP;
+            keyEvent.down = a_event.type == ReplayFormat::EventType::KeyDown;
+            keyEvent.key = a_event.key;
+            a_levelController.HandleKeyboardEvent(keyEvent);
+            break;
+        }
+
+        case ReplayFormat::EventType::MouseButtonDown:
+        case ReplayFormat::EventType::MouseButtonUp:
+        {
+            SDL_MouseButtonEvent mouseButtonEvent;
+            SDL_zero(mouseButtonEvent);
+            mouseButtonEvent.type = a_event.type == ReplayFormat::EventType::MouseButtonDown ? SDL_EVENT_MOUSE_BUTTON_DOWN : SDL_EVENT_MOUSE_BUTTON_UP;
+            mouseButtonEvent.down = a_event.type == ReplayFormat::EventType::MouseButtonDown;
+            mouseButtonEvent.button = a_event.mouseButton;
+            a_levelController.HandleMouseButtonEvent(mouseButtonEvent, a_event.levelPosition);
+            break;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "LevelController.hpp"
+#include "MappedFile.hpp"
+#include "ReplayFormat.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <memory>
+
+class GeometryEngine;
+class LevelFactory;
+
+struct ReplayResult
+{
+    bool stateMatched = false;
+    Uint64 ticks = 0;
+    Uint64 firstMismatchTick = 0;
+    Uint32 score = 0;
+};
+
+// Plays a replay file back and checks the state hash after every tick. Every playback resets the same
+// LevelController from the level built when the file was loaded.
+class ReplayPlayer
+{
+public:
+    explicit ReplayPlayer(std::shared_ptr<LevelFactory> a_levelFactory_sp,
+                          std::shared_ptr<GeometryEngine> a_geometryEngine_sp);
+    virtual ~ReplayPlayer() = default;
+
+    bool Load(const char* a_path);
+    const ReplayHeader& Header() const;
+
+    ReplayResult Play();
+
+private:
+    void applyEvent(LevelController& a_levelController, const ReplayEvent& a_event) const;
+
+private:
+    std::shared_ptr<LevelFactory> m_levelFactory_sp;
+    std::shared_ptr<GeometryEngine> m_geometryEngine_sp;
+
+    MappedFile m_file;
+    const ReplayHeader* m_header_p;
+    const ReplayEvent* m_events_p;
+    const Uint64* m_stateHashes_p;
+
+    Level m_startLevel;
+    LevelController m_levelController;
+};
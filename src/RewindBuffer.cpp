@@ -0,0 +1,64 @@
+#include "RewindBuffer.hpp"
+
+#include "LevelController.hpp"
+
+RewindBuffer::RewindBuffer(const int a_capacity)
+    : m_snapshots(SDL_max(a_capacity, 1))
+    , m_newest(0)
+    , m_count(0)
+{
+}
+
+int
+RewindBuffer::Capacity() const
+{
+    return (int)m_snapshots.size();
+}
+
+int
+RewindBuffer::Size() const
+{
+    // The newest snapshot is the current state, rewinding goes back from there
+    return SDL_max(m_count - 1, 0);
+}
+
+void
+RewindBuffer::Clear()
+{
+    m_count = 0;
+}
+
+bool
+RewindBuffer::Record(const LevelController& a_levelController)
+{
+    const int slot = (m_newest + 1) % Capacity();
+    if (!a_levelController.Snapshot(m_snapshots[slot]))
+    {
+        Clear();
+        return false;
+    }
+
+    m_newest = slot;
+    m_count = SDL_min(m_count + 1, Capacity());
+    return true;
+}
+
+int
+RewindBuffer::Rewind(LevelController& a_levelController, const int a_ticks)
+{
+    const int ticks = SDL_clamp(a_ticks, 0, Size());
+    if (ticks == 0)
+    {
+        return 0;
+    }
+
+    m_newest = (m_newest - ticks + Capacity()) % Capacity();
+    m_count -= ticks;
+    if (!a_levelController.Restore(m_snapshots[m_newest]))
+    {
+        Clear();
+        return 0;
+    }
+
+    return ticks;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "gameobjects/LevelSnapshot.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <vector>
+
+class LevelController;
+
+// Ring of level snapshots of the most recent ticks. The ring is allocated once, recording a tick only
+// copies the state into the oldest slot.
+class RewindBuffer
+{
+public:
+    explicit RewindBuffer(const int a_capacity);
+    virtual ~RewindBuffer() = default;
+
+    int Capacity() const;
+    // Number of ticks that can be rewound
+    int Size() const;
+    void Clear();
+
+    // Stores the state after a tick, the oldest one is dropped once the ring is full. Levels too large
+    // for a snapshot clear the ring and return false.
+    bool Record(const LevelController& a_levelController);
+
+    // Goes back a_ticks recorded ticks, or as far as the ring reaches, and forgets the ticks after that.
+    // Returns the number of ticks actually rewound.
+    int Rewind(LevelController& a_levelController, const int a_ticks);
+
+private:
+    std::vector<LevelSnapshot> m_snapshots;
+    // Slot of the newest snapshot
+    int m_newest;
+    int m_count;
+};
@@ -0,0 +1,82 @@
+#include "SimulationClock.hpp"
+
+SimulationClock::SimulationClock(const Uint32 a_tickRateHz, const int a_maxTicksPerAdvance)
+    : m_tickRateHz(0)
+    , m_tickNS(0)
+    , m_maxTicksPerAdvance(a_maxTicksPerAdvance)
+    , m_lastNS(0)
+    , m_accumulatorNS(0)
+    , m_droppedTicks(0)
+{
+    SetTickRate(a_tickRateHz);
+}
+
+void
+SimulationClock::SetTickRate(const Uint32 a_tickRateHz)
+{
+    m_tickRateHz = SDL_max(a_tickRateHz, 1u);
+    m_tickNS = SDL_NS_PER_SECOND / m_tickRateHz;
+}
+
+void
+SimulationClock::Reset(const Uint64 a_nowNS)
+{
+    m_lastNS = a_nowNS;
+    m_accumulatorNS = 0;
+    m_droppedTicks = 0;
+}
+
+int
+SimulationClock::Advance(const Uint64 a_nowNS)
+{
+    m_accumulatorNS += a_nowNS - m_lastNS;
+    m_lastNS = a_nowNS;
+
+    const Uint64 dueTicks = m_accumulatorNS / m_tickNS;
+    m_accumulatorNS -= dueTicks * m_tickNS;
+
+    if (dueTicks > (Uint64)m_maxTicksPerAdvance)
+    {
+        m_droppedTicks += dueTicks - m_maxTicksPerAdvance;
+        return m_maxTicksPerAdvance;
+    }
+
+    return (int)dueTicks;
+}
+
+Uint64
+SimulationClock::SimulatedNS() const
+{
+    return m_lastNS - m_accumulatorNS;
+}
+
+Uint32
+SimulationClock::TickRateHz() const
+{
+    return m_tickRateHz;
+}
+
+Uint64
+SimulationClock::TickNS() const
+{
+    return m_tickNS;
+}
+
+float
+SimulationClock::TickSeconds() const
+{
+    // Always the same value for a given rate, so every tick integrates with bit-identical steps
+    return 1.0f / (float)m_tickRateHz;
+}
+
+float
+SimulationClock::Alpha() const
+{
+    return (float)m_accumulatorNS / (float)m_tickNS;
+}
+
+Uint64
+SimulationClock::DroppedTicks() const
+{
+    return m_droppedTicks;
+}
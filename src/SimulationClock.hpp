@@ -0,0 +1,38 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+// Fixed timestep accumulator. Wall clock time is fed in and converted into a whole number of
+// simulation ticks of constant length, so the simulation does not depend on the frame timing.
+class SimulationClock
+{
+public:
+    explicit SimulationClock(const Uint32 a_tickRateHz, const int a_maxTicksPerAdvance);
+    virtual ~SimulationClock() = default;
+
+    void SetTickRate(const Uint32 a_tickRateHz);
+    void Reset(const Uint64 a_nowNS);
+
+    // Returns how many ticks to simulate to catch up with a_nowNS. At most a_maxTicksPerAdvance are
+    // returned, the time that could not be caught up with is dropped so a long hitch cannot spiral.
+    int Advance(const Uint64 a_nowNS);
+
+    // Wall clock time the ticks returned so far have caught up with, the last of them ends here and
+    // every earlier one a tick length before
+    Uint64 SimulatedNS() const;
+
+    Uint32 TickRateHz() const;
+    Uint64 TickNS() const;
+    float TickSeconds() const;
+    float Alpha() const;
+    Uint64 DroppedTicks() const;
+
+private:
+    Uint32 m_tickRateHz;
+    Uint64 m_tickNS;
+    int m_maxTicksPerAdvance;
+
+    Uint64 m_lastNS;
+    Uint64 m_accumulatorNS;
+    Uint64 m_droppedTicks;
+};
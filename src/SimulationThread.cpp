@@ -0,0 +1,442 @@
+#include "SimulationThread.hpp"
+
+#include "Constants.hpp"
+#include "GeometryEngine.hpp"
+#include "LevelController.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+
+// Longer logs restart, slots that are further behind copy all bricks
+const size_t MaxLoggedBrickChanges = 4096;
+
+}
+
+SimulationThread::SimulationThread(std::shared_ptr<GeometryEngine> a_geometryEngine_sp)
+    : m_geometryEngine_sp(a_geometryEngine_sp)
+    , m_levelController_sp(nullptr)
+    , m_thread_p(nullptr)
+    , m_inputAvailable_p(SDL_CreateSemaphore(0))
+    , m_fixedTimestep(true)
+    , m_simulationClock(Constants::DefaultSimulationTickRateHz, Constants::MaxCatchUpTicksPerFrame)
+    , m_rewindBuffer(Constants::RewindHistoryTicks)
+    , m_rewindAvailable(false)
+    , m_rewindUnavailableReported(false)
+    , m_levelStart(0)
+    , m_publishedFrames(0)
+    , m_appliedInputs(0)
+    , m_frameAvailable(false)
+{
+    SDL_SetAtomicInt(&m_stopping, 0);
+    SDL_SetAtomicInt(&m_waitingForInput, 0);
+}
+
+SimulationThread::~SimulationThread()
+{
+    Stop();
+    SDL_DestroySemaphore(m_inputAvailable_p);
+}
+
+void
+SimulationThread::SetTickRate(const Uint32 a_tickRateHz)
+{
+    // The variable timestep mode still wakes up at the default rate, it just steps by the measured time
+    m_fixedTimestep = a_tickRateHz > 0;
+    m_simulationClock.SetTickRate(m_fixedTimestep ? a_tickRateHz : Constants::DefaultSimulationTickRateHz);
+}
+
+Uint32
+SimulationThread::TickRateHz() const
+{
+    return m_fixedTimestep ? m_simulationClock.TickRateHz() : 0;
+}
+
+void
+SimulationThread::SetRecordingPath(const std::string& a_path)
+{
+    m_recordingPath = a_path;
+}
+
+bool
+SimulationThread::Start(const Level& a_startLevel, const Uint64 a_randomSeed)
+{
+    if (m_thread_p)
+    {
+        return false;
+    }
+
+    m_startLevel = a_startLevel;
+    if (!m_levelController_sp)
+    {
+        m_levelController_sp = std::make_shared<LevelController>(m_geometryEngine_sp, m_startLevel);
+    }
+
+    // The first frame is there before the thread runs, so the main thread never waits for it
+    m_motion.previousBallCenters.reserve(Constants::MaxBallsInPlay);
+    m_brickChanges.bricks.reserve(MaxLoggedBrickChanges);
+    restartLevel(a_randomSeed);
+    recordPreviousPositions();
+    m_motion.stepEndNS = SDL_GetTicksNS();
+    m_motion.stepNS = m_simulationClock.TickNS();
+    publishFrame();
+
+    SDL_SetAtomicInt(&m_stopping, 0);
+    m_thread_p = SDL_CreateThread(threadMain, "Simulation", this);
+    if (!m_thread_p)
+    {
+        SDL_Log("Couldn't create simulation thread: %s", SDL_GetError());
+        return false;
+    }
+
+    return true;
+}
+
+void
+SimulationThread::Stop()
+{
+    if (!m_thread_p)
+    {
+        return;
+    }
+
+    SDL_SetAtomicInt(&m_stopping, 1);
+    SDL_SignalSemaphore(m_inputAvailable_p);
+    SDL_WaitThread(m_thread_p, nullptr);
+    m_thread_p = nullptr;
+
+    finishRecording();
+}
+
+bool
+SimulationThread::Running() const
+{
+    return m_thread_p != nullptr;
+}
+
+bool
+SimulationThread::PushInput(const TimedInput& a_input)
+{
+    if (!m_inputQueue.Push(a_input))
+    {
+        return false;
+    }
+
+    // Either the thread sees the input before going to sleep, or this sees it sleeping
+    if (SDL_GetAtomicInt(&m_waitingForInput) != 0)
+    {
+        SDL_SignalSemaphore(m_inputAvailable_p);
+    }
+    return true;
+}
+
+const SimulationFrame*
+SimulationThread::AcquireFrame()
+{
+    m_frameAvailable = m_frames.Acquire() || m_frameAvailable;
+    return m_frameAvailable ? &m_frames.ReadSlot() : nullptr;
+}
+
+void
+SimulationThread::MarkPresented(const Uint64 a_presentNS, const SimulationFrame& a_frame)
+{
+    m_inputQueue.MarkPresented(a_presentNS, a_frame.sequence);
+}
+
+InputLatencyStats
+SimulationThread::GetInputLatencyStats() const
+{
+    return m_inputQueue.GetLatencyStats();
+}
+
+int SDLCALL
+SimulationThread::threadMain(void* a_simulationThread_p)
+{
+    static_cast<SimulationThread*>(a_simulationThread_p)->run();
+    return 0;
+}
+
+void
+SimulationThread::run()
+{
+    Uint64 lastStepNS = SDL_GetTicksNS();
+    m_simulationClock.Reset(lastStepNS);
+
+    while (SDL_GetAtomicInt(&m_stopping) == 0)
+    {
+        const Uint64 nowNS = SDL_GetTicksNS();
+        const int ticks = m_simulationClock.Advance(nowNS);
+        if (ticks > 0)
+        {
+            ARKANOID_PROFILE_SCOPE(ProfilePhase::Simulation);
+
+            if (m_fixedTimestep)
+            {
+                // Input takes effect from the first tick that starts after it happened
+                const Uint64 simulatedNS = m_simulationClock.SimulatedNS();
+                for (int tick = 0; tick < ticks; tick++)
+                {
+                    applyQueuedInput(simulatedNS - (Uint64)(ticks - tick) * m_simulationClock.TickNS());
+                    step(m_simulationClock.TickSeconds());
+                }
+                m_motion.stepEndNS = simulatedNS;
+                m_motion.stepNS = m_simulationClock.TickNS();
+            }
+            else
+            {
+                applyQueuedInput(nowNS);
+                step((float)(nowNS - lastStepNS) / SDL_NS_PER_SECOND);
+                m_motion.stepEndNS = nowNS;
+                m_motion.stepNS = nowNS - lastStepNS;
+            }
+
+            lastStepNS = nowNS;
+            publishFrame();
+        }
+
+        if (idle())
+        {
+            waitForInput();
+            // The time asleep is not simulated, ticking resumes from now
+            lastStepNS = SDL_GetTicksNS();
+            m_simulationClock.Reset(lastStepNS);
+            continue;
+        }
+
+        // Sleeps until the next tick is due, the stop request is seen within a tick
+        const Uint64 nextTickNS = m_simulationClock.SimulatedNS() + m_simulationClock.TickNS();
+        const Uint64 wakeUpNS = SDL_GetTicksNS();
+        if (nextTickNS > wakeUpNS)
+        {
+            SDL_DelayPrecise(nextTickNS - wakeUpNS);
+        }
+    }
+}
+
+bool
+SimulationThread::idle()
+{
+    return (m_levelController_sp->GameOver() || m_levelController_sp->GetLevel().paused) && m_inputQueue.Empty();
+}
+
+void
+SimulationThread::waitForInput()
+{
+    SDL_SetAtomicInt(&m_waitingForInput, 1);
+    if (m_inputQueue.Empty() && SDL_GetAtomicInt(&m_stopping) == 0)
+    {
+        SDL_WaitSemaphore(m_inputAvailable_p);
+    }
+    SDL_SetAtomicInt(&m_waitingForInput, 0);
+}
+
+void
+SimulationThread::step(const float a_deltaSeconds)
+{
+    LevelController& levelController = *m_levelController_sp;
+    recordPreviousPositions();
+    if (levelController.GameOver())
+    {
+        return;
+    }
+
+    levelController.Iterate(a_deltaSeconds);
+    logHitBricks();
+    recordRewindState();
+    if (m_inputRecorder.IsRecording())
+    {
+        m_inputRecorder.RecordTick(levelController.StateHash());
+        if (levelController.GameOver())
+        {
+            finishRecording();
+        }
+    }
+}
+
+void
+SimulationThread::recordPreviousPositions()
+{
+    // Taken after the input of the tick, a restart or rewind jumps instead of sliding across the level
+    const Level& level = m_levelController_sp->GetLevel();
+    m_motion.previousPadPosition = {level.pad.geometry.rect.x, level.pad.geometry.rect.y};
+    m_motion.previousBallCenters.clear();
+    for (const Ball& ball : level.ballsInPlay)
+    {
+        m_motion.previousBallCenters.push_back(ball.geometry.center);
+    }
+}
+
+void
+SimulationThread::applyQueuedInput(const Uint64 a_timeNS)
+{
+    TimedInput input;
+    while (m_inputQueue.PopUntil(a_timeNS, m_publishedFrames + 1, input))
+    {
+        m_appliedInputs++;
+        applyInput(input);
+    }
+}
+
+void
+SimulationThread::applyInput(const TimedInput& a_input)
+{
+    switch (a_input.command)
+    {
+        case InputCommand::Restart:
+            restartLevel(a_input.event.common.timestamp);
+            m_levelStart++;
+            return;
+
+        case InputCommand::Rewind:
+            // A recording could not be replayed past the jump back
+            if (m_inputRecorder.IsRecording())
+            {
+                SDL_Log("Rewinding is not available while recording");
+            }
+            else if (!m_rewindAvailable)
+            {
+                SDL_Log("Rewinding is not available for this level");
+            }
+            else
+            {
+                m_rewindBuffer.Rewind(*m_levelController_sp, Constants::RewindStepTicks);
+                resetBrickChanges();
+            }
+            return;
+
+        case InputCommand::LevelEvent:
+            break;
+    }
+
+    const SDL_Event& event = a_input.event;
+    switch (event.type)
+    {
+        case SDL_EVENT_KEY_DOWN:
+        case SDL_EVENT_KEY_UP:
+            m_inputRecorder.RecordKeyboardEvent(event.key);
+            m_levelController_sp->HandleKeyboardEvent(event.key);
+            break;
+
+        case SDL_EVENT_MOUSE_MOTION:
+            m_levelController_sp->HandleMouseMotionEvent(event.motion, a_input.levelPosition);
+            break;
+
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        case SDL_EVENT_MOUSE_BUTTON_UP:
+            m_inputRecorder.RecordMouseButtonEvent(event.button, a_input.levelPosition);
+            m_levelController_sp->HandleMouseButtonEvent(event.button, a_input.levelPosition);
+            break;
+    }
+}
+
+void
+SimulationThread::restartLevel(const Uint64 a_randomSeed)
+{
+    finishRecording();
+
+    m_levelController_sp->Reset(m_startLevel);
+    m_levelController_sp->SetRandomSeed(a_randomSeed);
+    resetBrickChanges();
+    m_rewindBuffer.Clear();
+    m_rewindUnavailableReported = false;
+    recordRewindState();
+
+    if (!m_recordingPath.empty())
+    {
+        m_inputRecorder.Begin(a_randomSeed, m_startLevel.bounds, m_simulationClock.TickRateHz());
+    }
+}
+
+void
+SimulationThread::recordRewindState()
+{
+    // A snapshot has fixed room for balls and bricks. Levels with more bricks never fit, a multi-ball
+    // burst only takes rewinding away until enough balls are lost again.
+    m_rewindAvailable = m_rewindBuffer.Record(*m_levelController_sp);
+    if (!m_rewindAvailable && !m_rewindUnavailableReported)
+    {
+        const Level& level = m_levelController_sp->GetLevel();
+        SDL_Log("Rewind is disabled while the level has more than %d balls or %d bricks (%d balls, %d bricks)",
+                LevelSnapshot::MaxBalls, LevelSnapshot::MaxBricks, (int)level.ballsInPlay.size(), (int)level.bricks.Size());
+        m_rewindUnavailableReported = true;
+    }
+}
+
+void
+SimulationThread::finishRecording()
+{
+    if (m_inputRecorder.IsRecording() && m_inputRecorder.Save(m_recordingPath.c_str()))
+    {
+        SDL_Log("Replay saved to %s", m_recordingPath.c_str());
+    }
+}
+
+void
+SimulationThread::logHitBricks()
+{
+    const std::vector<Uint32>& hitBricks = m_levelController_sp->GetHitBricks();
+    if (m_brickChanges.bricks.size() + hitBricks.size() > MaxLoggedBrickChanges)
+    {
+        resetBrickChanges();
+    }
+    m_brickChanges.bricks.insert(m_brickChanges.bricks.end(), hitBricks.begin(), hitBricks.end());
+}
+
+void
+SimulationThread::resetBrickChanges()
+{
+    m_brickChanges.Restart();
+}
+
+void
+SimulationThread::publishFrame()
+{
+    const Level& level = m_levelController_sp->GetLevel();
+    SimulationFrame& frame = m_frames.WriteSlot();
+
+    // Hits only ever damage or remove bricks, replaying the ones the slot missed costs as much as the hits
+    // did. The slot's log is a prefix of the current one then and gets the same entries appended. A slot
+    // from before the start of the log copies the whole store, grid and log.
+    const std::vector<Uint32>& changedBricks = m_brickChanges.bricks;
+    if (frame.brickChanges.start == m_brickChanges.start)
+    {
+        BrickStore& frameBricks = frame.level.bricks;
+        const size_t firstMissed = frame.brickChanges.bricks.size();
+        for (size_t i = firstMissed; i < changedBricks.size(); i++)
+        {
+            const Uint32 brickIndex = changedBricks[i];
+            frameBricks.hitPoints[brickIndex] = level.bricks.hitPoints[brickIndex];
+            if (frameBricks.IsAlive(brickIndex) && !level.bricks.IsAlive(brickIndex))
+            {
+                frame.level.brickGrid.Remove(brickIndex, frameBricks.Rect(brickIndex));
+                frameBricks.Remove(brickIndex);
+            }
+        }
+        frameBricks.revision = level.bricks.revision;
+        frame.brickChanges.bricks.insert(frame.brickChanges.bricks.end(), changedBricks.begin() + firstMissed, changedBricks.end());
+    }
+    else
+    {
+        frame.level.bricks = level.bricks;
+        frame.level.brickGrid = level.brickGrid;
+        frame.brickChanges = m_brickChanges;
+    }
+
+    frame.level.bounds = level.bounds;
+    frame.level.pad = level.pad;
+    frame.level.ballsInPlay = level.ballsInPlay;
+    frame.level.paused = level.paused;
+    frame.level.balls = level.balls;
+    frame.level.score = level.score;
+    frame.motion.previousPadPosition = m_motion.previousPadPosition;
+    frame.motion.previousBallCenters = m_motion.previousBallCenters;
+    frame.motion.stepEndNS = m_motion.stepEndNS;
+    frame.motion.stepNS = m_motion.stepNS;
+    frame.gameOver = m_levelController_sp->GameOver();
+    frame.rewindAvailable = m_rewindAvailable && !m_inputRecorder.IsRecording();
+    frame.levelStart = m_levelStart;
+    frame.sequence = ++m_publishedFrames;
+    frame.appliedInputs = m_appliedInputs;
+
+    m_frames.Publish();
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "InputQueue.hpp"
+#include "InputRecorder.hpp"
+#include "RewindBuffer.hpp"
+#include "SimulationClock.hpp"
+#include "TripleBuffer.hpp"
+#include "gameobjects/BrickChangeLog.hpp"
+#include "gameobjects/Level.hpp"
+#include "gameobjects/LevelMotion.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class GeometryEngine;
+class LevelController;
+
+// Level state as published after a batch of simulation ticks
+struct SimulationFrame
+{
+    Level level;
+    LevelMotion motion;
+    // Bricks hit since the simulation's log last restarted, the brick store and grid are current up to its end
+    BrickChangeLog brickChanges;
+    bool gameOver = false;
+    // Off while recording and for levels too large for the rewind snapshots
+    bool rewindAvailable = false;
+    // Number of restarts before this frame, frames of the previous level are still in flight right after one
+    Uint32 levelStart = 0;
+    // Counts the published frames, the input latency is attributed by it
+    Uint64 sequence = 0;
+    // Inputs taken out of the queue so far, once it matches the inputs pushed the frame shows all of them
+    Uint64 appliedInputs = 0;
+};
+
+// Runs the level simulation on its own thread, ticking at the simulation rate no matter how long the
+// main thread takes to render and present. Input crosses over through the input queue and the level
+// state comes back through a triple buffer, neither direction takes a lock. While the level is paused or
+// over nothing changes until the next input, the thread sleeps on a semaphore then instead of ticking.
+class SimulationThread
+{
+public:
+    explicit SimulationThread(std::shared_ptr<GeometryEngine> a_geometryEngine_sp);
+    virtual ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Settings, only before Start. A tick rate of 0 selects the variable timestep mode, where each step
+    // simulates the whole time elapsed since the previous one.
+    void SetTickRate(const Uint32 a_tickRateHz);
+    Uint32 TickRateHz() const;
+    // Records every level played into a_path, the previous level gets overwritten
+    void SetRecordingPath(const std::string& a_path);
+
+    // Plays a_startLevel from now on, restarts are requested through the input queue. Only the first
+    // start allocates, the thread keeps running until Stop.
+    bool Start(const Level& a_startLevel, const Uint64 a_randomSeed);
+    // Joins the thread and saves a recording that is still in progress
+    void Stop();
+    bool Running() const;
+
+    // Main thread. Fails when the simulation is too far behind to take more input.
+    bool PushInput(const TimedInput& a_input);
+    // Main thread. The newest published frame, nullptr before the first one. Stays valid until the next call.
+    const SimulationFrame* AcquireFrame();
+    // Main thread. The frame was presented, the input it shows the effect of gets its latency recorded.
+    void MarkPresented(const Uint64 a_presentNS, const SimulationFrame& a_frame);
+    InputLatencyStats GetInputLatencyStats() const;
+
+private:
+    static int SDLCALL threadMain(void* a_simulationThread_p);
+    void run();
+    // The level is paused or over and there is no input to change that
+    bool idle();
+    void waitForInput();
+    void step(const float a_deltaSeconds);
+    void recordPreviousPositions();
+    // Applies the queued input that happened up to a_timeNS
+    void applyQueuedInput(const Uint64 a_timeNS);
+    void applyInput(const TimedInput& a_input);
+    void restartLevel(const Uint64 a_randomSeed);
+    // Records the current state into the rewind ring, reports once per level when it doesn't fit
+    void recordRewindState();
+    void finishRecording();
+    // Appends the bricks hit by the last step to the log, or restarts the log once it gets long
+    void logHitBricks();
+    // Bricks changed by something else than hits, every slot has to copy all bricks again
+    void resetBrickChanges();
+    void publishFrame();
+
+private:
+    std::shared_ptr<GeometryEngine> m_geometryEngine_sp;
+    std::shared_ptr<LevelController> m_levelController_sp;
+    Level m_startLevel;
+
+    SDL_Thread* m_thread_p;
+    SDL_AtomicInt m_stopping;
+    SDL_Semaphore* m_inputAvailable_p;
+    // Set while the thread sleeps or is about to, only then does pushing input signal the semaphore
+    SDL_AtomicInt m_waitingForInput;
+
+    bool m_fixedTimestep;
+    SimulationClock m_simulationClock;
+    InputQueue m_inputQueue;
+    RewindBuffer m_rewindBuffer;
+    bool m_rewindAvailable;
+    bool m_rewindUnavailableReported;
+    std::string m_recordingPath;
+    InputRecorder m_inputRecorder;
+    // Positions before the last step and its timing, published with the frame
+    LevelMotion m_motion;
+    // Publishing a slot only replays the hits it has not seen yet, instead of copying every brick
+    // whenever one is destroyed
+    BrickChangeLog m_brickChanges;
+
+    TripleBuffer<SimulationFrame> m_frames;
+    // Owned by the simulation thread
+    Uint32 m_levelStart;
+    Uint64 m_publishedFrames;
+    Uint64 m_appliedInputs;
+    // Owned by the main thread
+    bool m_frameAvailable;
+};
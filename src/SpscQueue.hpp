@@ -0,0 +1,66 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include <vector>
+
+// Bounded lock-free queue between exactly one producer thread and one consumer thread. Each index is
+// only written by its own side, the other side reads it to see how far the queue is filled, so neither
+// side ever waits for the other. Capacity has to be a power of two.
+template <typename T, Uint32 Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity has to be a power of two");
+
+public:
+    SpscQueue()
+        : m_items(Capacity)
+    {
+        SDL_SetAtomicU32(&m_head, 0);
+        SDL_SetAtomicU32(&m_tail, 0);
+    }
+    virtual ~SpscQueue() = default;
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side, fails when the queue is full
+    bool Push(const T& a_item)
+    {
+        const Uint32 tail = SDL_GetAtomicU32(&m_tail);
+        if (tail - SDL_GetAtomicU32(&m_head) == Capacity)
+        {
+            return false;
+        }
+
+        m_items[tail & (Capacity - 1)] = a_item;
+        // Publishing the new tail makes the item visible to the consumer
+        SDL_SetAtomicU32(&m_tail, tail + 1);
+        return true;
+    }
+
+    // Consumer side, the oldest item or nullptr when the queue is empty. Stays valid until Pop.
+    const T* Front()
+    {
+        const Uint32 head = SDL_GetAtomicU32(&m_head);
+        if (head == SDL_GetAtomicU32(&m_tail))
+        {
+            return nullptr;
+        }
+
+        return &m_items[head & (Capacity - 1)];
+    }
+
+    // Consumer side, drops the item returned by Front
+    void Pop()
+    {
+        SDL_SetAtomicU32(&m_head, SDL_GetAtomicU32(&m_head) + 1);
+    }
+
+private:
+    std::vector<T> m_items;
+
+    // On separate cache lines, so the two threads do not invalidate each other's index on every access
+    alignas(64) SDL_AtomicU32 m_head;
+    alignas(64) SDL_AtomicU32 m_tail;
+};
@@ -0,0 +1,213 @@
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(const int a_workerCount)
+    : m_stateMutex_p(SDL_CreateMutex())
+    , m_workAvailable_p(SDL_CreateCondition())
+    , m_allTasksDone_p(SDL_CreateCondition())
+    , m_stopping(false)
+    , m_startedWorkers(0)
+{
+    SDL_SetAtomicInt(&m_queuedTasks, 0);
+    SDL_SetAtomicInt(&m_unfinishedTasks, 0);
+    SDL_SetAtomicInt(&m_nextQueue, 0);
+    SDL_SetAtomicInt(&m_stolenTasks, 0);
+
+    const int workerCount = a_workerCount > 0 ? a_workerCount : SDL_max(SDL_GetNumLogicalCPUCores(), 1);
+
+    // All queues have to exist before the first worker may try to steal from them
+    for (int i = 0; i < workerCount; i++)
+    {
+        std::unique_ptr<Worker> worker = std::make_unique<Worker>();
+        worker->pool_p = this;
+        worker->index = i;
+        worker->queueMutex_p = SDL_CreateMutex();
+        m_workers.push_back(std::move(worker));
+    }
+
+    for (std::unique_ptr<Worker>& worker : m_workers)
+    {
+        worker->thread_p = SDL_CreateThread(workerMain, "PoolWorker", worker.get());
+        if (!worker->thread_p)
+        {
+            SDL_Log("Couldn't create worker thread: %s", SDL_GetError());
+            continue;
+        }
+        m_startedWorkers++;
+    }
+
+    // Tasks queued for a worker that never started are stolen by the others, without any Submit runs them
+    if (m_startedWorkers == 0)
+    {
+        SDL_Log("No worker thread started, tasks run on the submitting thread");
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    Wait();
+
+    SDL_LockMutex(m_stateMutex_p);
+    m_stopping = true;
+    SDL_BroadcastCondition(m_workAvailable_p);
+    SDL_UnlockMutex(m_stateMutex_p);
+
+    // Workers still look into each other's queues until they exit, so no queue goes away before all have
+    for (std::unique_ptr<Worker>& worker : m_workers)
+    {
+        if (worker->thread_p)
+        {
+            SDL_WaitThread(worker->thread_p, nullptr);
+        }
+    }
+
+    for (std::unique_ptr<Worker>& worker : m_workers)
+    {
+        SDL_DestroyMutex(worker->queueMutex_p);
+    }
+
+    SDL_DestroyCondition(m_allTasksDone_p);
+    SDL_DestroyCondition(m_workAvailable_p);
+    SDL_DestroyMutex(m_stateMutex_p);
+}
+
+int
+ThreadPool::WorkerCount() const
+{
+    return (int)m_workers.size();
+}
+
+void
+ThreadPool::Submit(Task a_task)
+{
+    // Nothing would ever take the task out of a queue
+    if (m_startedWorkers == 0)
+    {
+        a_task(0);
+        return;
+    }
+
+    Worker& worker = *m_workers[(Uint32)SDL_AddAtomicInt(&m_nextQueue, 1) % m_workers.size()];
+
+    SDL_AddAtomicInt(&m_unfinishedTasks, 1);
+    SDL_LockMutex(worker.queueMutex_p);
+    worker.tasks.push_back(std::move(a_task));
+    SDL_UnlockMutex(worker.queueMutex_p);
+    SDL_AddAtomicInt(&m_queuedTasks, 1);
+
+    // Taking the lock orders the wake up after a worker that is about to sleep has checked the counter
+    SDL_LockMutex(m_stateMutex_p);
+    SDL_SignalCondition(m_workAvailable_p);
+    SDL_UnlockMutex(m_stateMutex_p);
+}
+
+void
+ThreadPool::Wait()
+{
+    SDL_LockMutex(m_stateMutex_p);
+    while (SDL_GetAtomicInt(&m_unfinishedTasks) > 0)
+    {
+        SDL_WaitCondition(m_allTasksDone_p, m_stateMutex_p);
+    }
+    SDL_UnlockMutex(m_stateMutex_p);
+}
+
+Uint64
+ThreadPool::StolenTaskCount() const
+{
+    return (Uint64)SDL_GetAtomicInt(&m_stolenTasks);
+}
+
+int SDLCALL
+ThreadPool::workerMain(void* a_worker_p)
+{
+    Worker* worker_p = (Worker*)a_worker_p;
+    worker_p->pool_p->runWorker(*worker_p);
+    return 0;
+}
+
+void
+ThreadPool::runWorker(Worker& a_worker)
+{
+    Task task;
+    while (true)
+    {
+        if (popTask(a_worker, task) || stealTask(a_worker, task))
+        {
+            task(a_worker.index);
+            task = nullptr;
+            finishTask();
+            continue;
+        }
+
+        SDL_LockMutex(m_stateMutex_p);
+        while (SDL_GetAtomicInt(&m_queuedTasks) == 0 && !m_stopping)
+        {
+            SDL_WaitCondition(m_workAvailable_p, m_stateMutex_p);
+        }
+        const bool stopping = m_stopping && SDL_GetAtomicInt(&m_queuedTasks) == 0;
+        SDL_UnlockMutex(m_stateMutex_p);
+
+        if (stopping)
+        {
+            return;
+        }
+    }
+}
+
+bool
+ThreadPool::popTask(Worker& a_worker, Task& a_task)
+{
+    // Newest first, its data is the most likely to still be in this core's cache
+    SDL_LockMutex(a_worker.queueMutex_p);
+    const bool found = !a_worker.tasks.empty();
+    if (found)
+    {
+        a_task = std::move(a_worker.tasks.back());
+        a_worker.tasks.pop_back();
+        SDL_AddAtomicInt(&m_queuedTasks, -1);
+    }
+    SDL_UnlockMutex(a_worker.queueMutex_p);
+
+    return found;
+}
+
+bool
+ThreadPool::stealTask(const Worker& a_thief, Task& a_task)
+{
+    // Oldest first from the other end of the victim's queue, starting at the thief's neighbour so
+    // that idle workers do not all go after the same victim
+    const size_t workerCount = m_workers.size();
+    for (size_t offset = 1; offset < workerCount; offset++)
+    {
+        Worker& victim = *m_workers[(a_thief.index + offset) % workerCount];
+
+        SDL_LockMutex(victim.queueMutex_p);
+        const bool found = !victim.tasks.empty();
+        if (found)
+        {
+            a_task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            SDL_AddAtomicInt(&m_queuedTasks, -1);
+        }
+        SDL_UnlockMutex(victim.queueMutex_p);
+
+        if (found)
+        {
+            SDL_AddAtomicInt(&m_stolenTasks, 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+ThreadPool::finishTask()
+{
+    if (SDL_AddAtomicInt(&m_unfinishedTasks, -1) == 1)
+    {
+        SDL_LockMutex(m_stateMutex_p);
+        SDL_BroadcastCondition(m_allTasksDone_p);
+        SDL_UnlockMutex(m_stateMutex_p);
+    }
+}
\ No newline at end of file
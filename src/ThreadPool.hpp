@@ -0,0 +1,67 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Fixed set of worker threads with one task queue per worker. Submitted tasks are spread over the
+// queues, a worker takes the newest task from its own queue and, once that runs dry, steals the oldest
+// task from another worker. Tasks get the index of the worker running them, so callers can keep
+// per-worker state that is never touched by two threads.
+class ThreadPool
+{
+public:
+    typedef std::function<void(const int a_workerIndex)> Task;
+
+    // a_workerCount <= 0 uses one worker per logical CPU core. When no worker thread can be created,
+    // Submit runs each task right away on the calling thread as worker 0.
+    explicit ThreadPool(const int a_workerCount);
+    virtual ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int WorkerCount() const;
+
+    void Submit(Task a_task);
+    // Blocks until every submitted task has finished
+    void Wait();
+
+    // Number of tasks that ran on a different worker than the one they were queued on
+    Uint64 StolenTaskCount() const;
+
+private:
+    struct Worker
+    {
+        ThreadPool* pool_p = nullptr;
+        int index = 0;
+        SDL_Thread* thread_p = nullptr;
+        SDL_Mutex* queueMutex_p = nullptr;
+        std::deque<Task> tasks;
+    };
+
+    static int SDLCALL workerMain(void* a_worker_p);
+    void runWorker(Worker& a_worker);
+    bool popTask(Worker& a_worker, Task& a_task);
+    bool stealTask(const Worker& a_thief, Task& a_task);
+    void finishTask();
+
+private:
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    // Sleeping and waking up is done under m_stateMutex_p, the queues themselves only take their own lock
+    SDL_Mutex* m_stateMutex_p;
+    SDL_Condition* m_workAvailable_p;
+    SDL_Condition* m_allTasksDone_p;
+    bool m_stopping;
+    // Workers whose thread was created, the others only keep a queue the started ones steal from
+    int m_startedWorkers;
+
+    SDL_AtomicInt m_queuedTasks;
+    SDL_AtomicInt m_unfinishedTasks;
+    SDL_AtomicInt m_nextQueue;
+    mutable SDL_AtomicInt m_stolenTasks;
+};
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+// Hands the newest of a stream of values from one writer thread to one reader thread without locks.
+// The writer owns one of the three slots and the reader another, the third one holds the newest
+// published value. Publishing and acquiring each swap a slot with the shared one, so neither side ever
+// waits and the reader skips the values it was too slow to see.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer()
+        : m_writeSlot(0)
+        , m_readSlot(1)
+    {
+        SDL_SetAtomicInt(&m_sharedSlot, 2);
+    }
+    virtual ~TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer side. The slot holds whatever value it had when it was last handed back, the writer has to
+    // bring all of it up to date before publishing.
+    T& WriteSlot()
+    {
+        return m_slots[m_writeSlot];
+    }
+
+    void Publish()
+    {
+        m_writeSlot = SDL_SetAtomicInt(&m_sharedSlot, m_writeSlot | PublishedFlag) & SlotMask;
+    }
+
+    // Reader side, takes over the newest published value. Returns false when nothing was published
+    // since the last call, the read slot keeps the previous value then.
+    bool Acquire()
+    {
+        if ((SDL_GetAtomicInt(&m_sharedSlot) & PublishedFlag) == 0)
+        {
+            return false;
+        }
+
+        m_readSlot = SDL_SetAtomicInt(&m_sharedSlot, m_readSlot) & SlotMask;
+        return true;
+    }
+
+    const T& ReadSlot() const
+    {
+        return m_slots[m_readSlot];
+    }
+
+private:
+    static const int SlotMask = 3;
+    static const int PublishedFlag = 4;
+
+    T m_slots[3];
+    int m_writeSlot;
+    int m_readSlot;
+    // Index of the shared slot, with PublishedFlag set while it holds a value the reader has not taken
+    SDL_AtomicInt m_sharedSlot;
+};
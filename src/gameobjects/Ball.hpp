@@ -1,8 +1,9 @@
-#pragma once
-
-#include "gameobjects/ObjectGeometry.hpp"
-
-struct Ball
-{
-    CircleGeometry geometry;
+#pragma once
+
+#include "gameobjects/ObjectGeometry.hpp"
+
+struct Ball
+{
+    CircleGeometry geometry;
+    bool launched = false;
 };
\ No newline at end of file
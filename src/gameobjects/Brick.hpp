@@ -1,19 +1,22 @@
-#pragma once
-
-#include "gameobjects/ObjectGeometry.hpp"
-
-enum class BrickKind
-{
-    LowScore,
-    NormalScore,
-    HighScore,
-    Solid
-};
-
-struct Brick
-{
-    RectGeometry geometry;
-    
-    BrickKind kind = BrickKind::NormalScore;
-    int hitPoints = 1;
+#pragma once
+
+#include "gameobjects/ObjectGeometry.hpp"
+
+enum class BrickKind
+{
+    LowScore,
+    NormalScore,
+    HighScore,
+    Solid,
+    MultiBall
+};
+
+const int BrickKindCount = (int)BrickKind::MultiBall + 1;
+
+struct Brick
+{
+    RectGeometry geometry;
+    
+    BrickKind kind = BrickKind::NormalScore;
+    int hitPoints = 1;
 };
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include <vector>
+
+// Indices of the bricks hit during a level, in hit order. Positions count every logged hit, so the
+// bricks of a log start at position start and a reader that has seen everything up to some position
+// only looks at the entries from there on. A new log starts past the end of the previous one, a reader
+// that is behind the start has missed changes and has to look at all bricks instead.
+struct BrickChangeLog
+{
+    Uint64 start = 0;
+    std::vector<Uint32> bricks;
+
+    Uint64 End() const
+    {
+        return start + bricks.size();
+    }
+
+    // Whether the entries after a_position are all still in the log
+    bool Covers(const Uint64 a_position) const
+    {
+        return a_position >= start && a_position <= End();
+    }
+
+    // Starts a new log, even a reader that has seen the whole old one is behind it
+    void Restart()
+    {
+        start = End() + 1;
+        bricks.clear();
+    }
+};
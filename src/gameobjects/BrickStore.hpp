@@ -0,0 +1,118 @@
+#pragma once
+
+#include "gameobjects/Brick.hpp"
+
+#include <vector>
+
+// Structure-of-arrays storage of the bricks in a level. Collision code reads the rect arrays
+// directly, Brick is only used as a value type to add bricks or read one back.
+// Destroyed bricks are only marked dead, so removal is O(1) and the storage (and render) order
+// of the remaining bricks never changes. Indices stay valid for the lifetime of the level.
+struct BrickStore
+{
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> w;
+    std::vector<float> h;
+    std::vector<BrickKind> kind;
+    std::vector<int> hitPoints;
+    std::vector<Uint8> alive;
+    size_t aliveCount = 0;
+    // Bumped whenever a brick is added or removed, lets caches of the brick layout know when to rebuild
+    Uint64 revision = 0;
+
+    // Number of stored bricks, including dead ones
+    size_t Size() const
+    {
+        return x.size();
+    }
+
+    bool Empty() const
+    {
+        return aliveCount == 0;
+    }
+
+    bool IsAlive(const size_t a_index) const
+    {
+        return alive[a_index] != 0;
+    }
+
+    SDL_FRect Rect(const size_t a_index) const
+    {
+        return {x[a_index], y[a_index], w[a_index], h[a_index]};
+    }
+
+    Brick Get(const size_t a_index) const
+    {
+        Brick brick;
+        brick.geometry.properties.isSolid = true;
+        brick.geometry.properties.isVisible = true;
+        brick.geometry.rect = Rect(a_index);
+        brick.kind = kind[a_index];
+        brick.hitPoints = hitPoints[a_index];
+
+        return brick;
+    }
+
+    void Add(const Brick& a_brick)
+    {
+        x.push_back(a_brick.geometry.rect.x);
+        y.push_back(a_brick.geometry.rect.y);
+        w.push_back(a_brick.geometry.rect.w);
+        h.push_back(a_brick.geometry.rect.h);
+        kind.push_back(a_brick.kind);
+        hitPoints.push_back(a_brick.hitPoints);
+        alive.push_back(1);
+        aliveCount++;
+        revision++;
+    }
+
+    void Reserve(const size_t a_count)
+    {
+        x.reserve(a_count);
+        y.reserve(a_count);
+        w.reserve(a_count);
+        h.reserve(a_count);
+        kind.reserve(a_count);
+        hitPoints.reserve(a_count);
+        alive.reserve(a_count);
+    }
+
+    // Grows or shrinks the store to a_count alive bricks in one step, so generators can fill disjoint
+    // index ranges from several threads. The new bricks are zero sized until they are written.
+    void Resize(const size_t a_count)
+    {
+        x.resize(a_count);
+        y.resize(a_count);
+        w.resize(a_count);
+        h.resize(a_count);
+        kind.resize(a_count);
+        hitPoints.resize(a_count);
+        alive.assign(a_count, 1);
+        aliveCount = a_count;
+        revision++;
+    }
+
+    void Remove(const size_t a_index)
+    {
+        if (alive[a_index])
+        {
+            alive[a_index] = 0;
+            aliveCount--;
+            revision++;
+        }
+    }
+
+    void Clear()
+    {
+        x.clear();
+        y.clear();
+        w.clear();
+        h.clear();
+        kind.clear();
+        hitPoints.clear();
+        alive.clear();
+        aliveCount = 0;
+        revision++;
+    }
+};
@@ -1,20 +1,21 @@
-#pragma once
-
-#include "Ball.hpp"
-#include "Constants.hpp"
-#include "Brick.hpp"
-#include "Pad.hpp"
-
-#include <vector>
-
-struct Level {
-    SDL_FRect bounds;
-    Pad pad;
-    std::vector<Brick> bricks;
-    Ball ball;
-
-    bool paused = false;
-    bool ballLaunched = false;
-    int balls = Constants::StartingBallCount;
-    Uint32 score = 0;
+#pragma once
+
+#include "Ball.hpp"
+#include "BrickGrid.hpp"
+#include "Constants.hpp"
+#include "BrickStore.hpp"
+#include "Pad.hpp"
+
+#include <vector>
+
+struct Level {
+    SDL_FRect bounds;
+    Pad pad;
+    BrickStore bricks;
+    BrickGrid brickGrid;
+    std::vector<Ball> ballsInPlay;
+
+    bool paused = false;
+    int balls = Constants::StartingBallCount;
+    Uint32 score = 0;
 };
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Constants.hpp"
+
+#include <SDL3/SDL.h>
+
+#include <vector>
+
+// Brick layout of a level, independent of the bounds the level is built in. Level files are text, one
+// setting or brick row per line, '#' starts a comment and every setting is optional:
+//   brick W H        brick size
+//   spacing S        gap between bricks and rows
+//   margin M         distance of the first row from the top of the level
+//   pad W H          pad size
+//   balls N          balls left after the first one is lost
+//   row CELLS        one brick row, centered in the level, top row first. Cells are
+//                    '.' empty, 'L' low score, 'N' normal score, 'H' high score, 'S' solid, 'M' multi-ball
+struct LevelLayout
+{
+    static const Uint8 EmptyCell = 0xff;
+
+    SDL_FPoint brickSize{70.0f, 35.0f};
+    float brickSpacing = 15.0f;
+    float topMargin = 80.0f;
+    SDL_FPoint padSize{140.0f, 25.0f};
+    int balls = Constants::StartingBallCount;
+
+    // Cells of row r are cells[rowStarts[r]] up to cells[rowStarts[r + 1]], each a BrickKind or EmptyCell
+    std::vector<Uint32> rowStarts{0};
+    std::vector<Uint8> cells;
+    Uint32 brickCount = 0;
+    // Row with the most cells, it decides whether the layout fits the level bounds
+    Uint32 widestRow = 0;
+
+    size_t RowCount() const
+    {
+        return rowStarts.size() - 1;
+    }
+
+    // Width of a row from its first to its last cell, empty cells count too
+    float RowWidth(const size_t a_row) const
+    {
+        const Uint32 cellCount = rowStarts[a_row + 1] - rowStarts[a_row];
+        return brickSize.x * cellCount + brickSpacing * (cellCount - 1);
+    }
+
+    void Clear()
+    {
+        *this = LevelLayout();
+    }
+};
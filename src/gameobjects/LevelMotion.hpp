@@ -0,0 +1,30 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include <vector>
+
+// Where the pad and the balls were at the start of the last simulation step and when that step ended,
+// so frames rendered between two steps can blend the previous positions with the current ones
+struct LevelMotion
+{
+    SDL_FPoint previousPadPosition = {0.0f, 0.0f};
+    // Same order as Level::ballsInPlay. When balls were added or lost during the step the sizes differ,
+    // the balls are drawn where they are then.
+    std::vector<SDL_FPoint> previousBallCenters;
+
+    Uint64 stepEndNS = 0;  // Wall clock time the step caught up with
+    Uint64 stepNS = 0;     // Length of the step
+
+    // How far between the previous and the current positions a frame shown at a_nowNS is, the frame
+    // lags a step behind the simulation so it never has to extrapolate
+    float Alpha(const Uint64 a_nowNS) const
+    {
+        if (stepNS == 0 || a_nowNS <= stepEndNS)
+        {
+            return 0.0f;
+        }
+
+        return SDL_min((float)(a_nowNS - stepEndNS) / (float)stepNS, 1.0f);
+    }
+};
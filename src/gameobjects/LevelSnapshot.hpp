@@ -0,0 +1,52 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+
+#include <type_traits>
+
+// Ball as stored in a snapshot, without the optional velocity of CircleGeometry
+struct BallSnapshot
+{
+    SDL_FPoint center;
+    SDL_FPoint velocity;
+    float radius;
+    Uint8 hasVelocity;
+    Uint8 launched;
+};
+
+// Everything the simulation of a level changes, stored in fixed size arrays so a snapshot is trivially
+// copyable and can be kept in plain arrays or written out as bytes. The static level data (bounds, brick
+// rects and kinds) is not part of it, a snapshot can only be restored into the level it was taken from.
+struct LevelSnapshot
+{
+    static const int MaxBalls = 32;
+    static const int MaxBricks = 1024;
+
+    // Pad
+    SDL_FRect padRect;
+    SDL_FPoint padVelocity;
+    float padSpeed;
+    Uint8 padHasVelocity;
+    Uint8 padMovingLeft;
+    Uint8 padMovingRight;
+
+    // Level
+    Uint8 paused;
+    Uint8 gameOver;
+    int balls;
+    Uint32 score;
+    Uint64 randomState;
+
+    Uint32 ballCount;
+    BallSnapshot ballsInPlay[MaxBalls];
+    // Sweep order of the ball collisions, it carries over from one tick to the next
+    Uint32 ballOrderCount;
+    Uint8 ballOrder[MaxBalls];
+
+    Uint32 brickCount;
+    Uint32 brickAliveCount;
+    Uint8 brickAlive[MaxBricks];
+    Uint8 brickHitPoints[MaxBricks];
+};
+
+static_assert(std::is_trivially_copyable<LevelSnapshot>::value, "LevelSnapshot has to stay copyable with memcpy");
@@ -1,13 +1,13 @@
-#pragma once
-
-#include "Constants.hpp"
-#include "gameobjects/ObjectGeometry.hpp"
-
-struct Pad
-{
-    RectGeometry geometry;
-
-    float speed = Constants::StartingBallSpeed;
-    bool movingLeft = false;
-    bool movingRight = false;
+#pragma once
+
+#include "Constants.hpp"
+#include "gameobjects/ObjectGeometry.hpp"
+
+struct Pad
+{
+    RectGeometry geometry;
+
+    float speed = Constants::StartingBallSpeed;
+    bool movingLeft = false;
+    bool movingRight = false;
 };
\ No newline at end of file
@@ -0,0 +1,347 @@
+#include <SDL3/SDL.h>
+
+#include "Constants.hpp"
+#include "GeometryEngine.hpp"
+#include "HeadlessRunner.hpp"
+#include "InputRecorder.hpp"
+#include "LevelFactory.hpp"
+#include "ParallelEpisodeRunner.hpp"
+#include "Profiler.hpp"
+#include "Renderer.hpp"
+#include "ReplayPlayer.hpp"
+#include "gameobjects/Level.hpp"
+
+#include <vector>
+
+namespace
+{
+
+const int DefaultEpisodeCount = 1000;
+const Uint64 DefaultMaxGameSeconds = 60 * 10;
+
+struct Options
+{
+    int episodeCount = DefaultEpisodeCount;
+    Uint64 maxTicks = 0;
+    Uint32 tickRateHz = Constants::DefaultSimulationTickRateHz;
+    Uint64 seed = 0;
+    int extraBalls = 0;
+    int threadCount = 0;
+    bool printEpisodes = false;
+    bool measureScaling = false;
+    bool stressLevel = false;
+    StressLevelOptions stressLevelOptions;
+    const char* recordPath_p = nullptr;
+    const char* replayPath_p = nullptr;
+    const char* tracePath_p = nullptr;
+    std::vector<const char*> checkLevelPaths;
+};
+
+double
+secondsSince(const Uint64 a_startCounter)
+{
+    return (double)(SDL_GetPerformanceCounter() - a_startCounter) / (double)SDL_GetPerformanceFrequency();
+}
+
+Uint64
+maxTicks(const Options& a_options)
+{
+    return a_options.maxTicks > 0 ? a_options.maxTicks : DefaultMaxGameSeconds * a_options.tickRateHz;
+}
+
+int
+runEpisodes(const Options& a_options)
+{
+    // The renderer is never initialized - it only provides the level layout the game would use
+    ParallelEpisodeRunner runner(Renderer().LevelBounds(), a_options.threadCount);
+    if (a_options.stressLevel)
+    {
+        runner.SetStressLevel(a_options.stressLevelOptions);
+    }
+    InputRecorder recorder;
+    std::vector<EpisodeResult> results;
+
+    const Uint64 startCounter = SDL_GetPerformanceCounter();
+    runner.RunEpisodes(a_options.seed,
+                       a_options.episodeCount,
+                       maxTicks(a_options),
+                       a_options.tickRateHz,
+                       a_options.extraBalls,
+                       a_options.recordPath_p ? &recorder : nullptr,
+                       results);
+    const double elapsedSeconds = secondsSince(startCounter);
+
+    Uint64 totalTicks = 0;
+    Uint64 totalNarrowphaseTests = 0;
+    Uint64 totalScore = 0;
+    int levelsCleared = 0;
+    for (size_t episode = 0; episode < results.size(); episode++)
+    {
+        const EpisodeResult& result = results[episode];
+        totalTicks += result.ticks;
+        totalNarrowphaseTests += result.narrowphaseTests;
+        totalScore += result.score;
+        levelsCleared += result.levelCleared ? 1 : 0;
+
+        if (a_options.printEpisodes)
+        {
+            SDL_Log("episode %d: score %u, balls left %d, ticks %llu, %s",
+                    (int)episode, result.score, result.ballsLeft, (unsigned long long)result.ticks, result.levelCleared ? "cleared" : "lost");
+        }
+    }
+
+    SDL_Log("episodes: %d, threads: %d, ticks: %llu, elapsed: %.3f s",
+            a_options.episodeCount, runner.WorkerCount(), (unsigned long long)totalTicks, elapsedSeconds);
+    SDL_Log("episodes/sec: %.1f, ticks/sec: %.0f", a_options.episodeCount / elapsedSeconds, totalTicks / elapsedSeconds);
+    SDL_Log("narrowphase tests/tick: %.2f", totalTicks > 0 ? (double)totalNarrowphaseTests / totalTicks : 0.0);
+    SDL_Log("levels cleared: %d, average score: %.1f", levelsCleared, a_options.episodeCount > 0 ? (double)totalScore / a_options.episodeCount : 0.0);
+
+    if (a_options.recordPath_p && recorder.Save(a_options.recordPath_p))
+    {
+        SDL_Log("episode 0 recorded to %s", a_options.recordPath_p);
+    }
+
+    return 0;
+}
+
+// Plays the same episodes with 1, 2, 4, ... workers up to the number of cores and reports the speedup
+int
+runScaling(const Options& a_options)
+{
+    const SDL_FRect levelBounds = Renderer().LevelBounds();
+    const int maxWorkerCount = a_options.threadCount > 0 ? a_options.threadCount : SDL_max(SDL_GetNumLogicalCPUCores(), 1);
+    std::vector<EpisodeResult> results;
+    double singleWorkerSeconds = 0.0;
+
+    for (int workerCount = 1; ; workerCount = SDL_min(workerCount * 2, maxWorkerCount))
+    {
+        ParallelEpisodeRunner runner(levelBounds, workerCount);
+        if (a_options.stressLevel)
+        {
+            runner.SetStressLevel(a_options.stressLevelOptions);
+        }
+
+        const Uint64 startCounter = SDL_GetPerformanceCounter();
+        runner.RunEpisodes(a_options.seed, a_options.episodeCount, maxTicks(a_options), a_options.tickRateHz, a_options.extraBalls, nullptr, results);
+        const double elapsedSeconds = secondsSince(startCounter);
+
+        if (workerCount == 1)
+        {
+            singleWorkerSeconds = elapsedSeconds;
+        }
+
+        const double speedup = singleWorkerSeconds / elapsedSeconds;
+        SDL_Log("threads: %2d, episodes/sec: %9.1f, speedup: %5.2fx, efficiency: %5.1f%%, stolen batches: %llu",
+                workerCount, a_options.episodeCount / elapsedSeconds, speedup, 100.0 * speedup / workerCount,
+                (unsigned long long)runner.StolenTaskCount());
+
+        if (workerCount == maxWorkerCount)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+int
+runReplay(const Options& a_options)
+{
+    ReplayPlayer player(std::make_shared<LevelFactory>(), std::make_shared<GeometryEngine>());
+    if (!player.Load(a_options.replayPath_p))
+    {
+        return 1;
+    }
+
+    Uint64 totalTicks = 0;
+    int mismatches = 0;
+
+    const Uint64 startCounter = SDL_GetPerformanceCounter();
+    for (int run = 0; run < a_options.episodeCount; run++)
+    {
+        const ReplayResult result = player.Play();
+        totalTicks += result.ticks;
+
+        if (!result.stateMatched)
+        {
+            if (mismatches == 0)
+            {
+                SDL_Log("replay diverged from the recording at tick %llu", (unsigned long long)result.firstMismatchTick);
+            }
+            mismatches++;
+        }
+    }
+    const double elapsedSeconds = secondsSince(startCounter);
+
+    SDL_Log("replays: %d of %llu ticks, elapsed: %.3f s", a_options.episodeCount, (unsigned long long)player.Header().tickCount, elapsedSeconds);
+    SDL_Log("replays/sec: %.1f, ticks/sec: %.0f", a_options.episodeCount / elapsedSeconds, totalTicks / elapsedSeconds);
+    SDL_Log("state hash mismatches: %d", mismatches);
+
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Loads every level file into the bounds the game uses and checks that each of its bricks can be reached
+int
+runLevelCheck(const Options& a_options)
+{
+    const SDL_FRect levelBounds = Renderer().LevelBounds();
+    LevelFactory levelFactory;
+    Level level;
+    int failedLevels = 0;
+
+    for (const char* path_p : a_options.checkLevelPaths)
+    {
+        if (!levelFactory.LoadLevel(path_p, levelBounds, level))
+        {
+            SDL_Log("%s: level doesn't load", path_p);
+            failedLevels++;
+            continue;
+        }
+
+        int outsideBricks = 0;
+        for (size_t i = 0; i < level.bricks.Size(); i++)
+        {
+            const SDL_FRect rect = level.bricks.Rect(i);
+            if (rect.x < levelBounds.x || rect.y < levelBounds.y ||
+                rect.x + rect.w > levelBounds.x + levelBounds.w || rect.y + rect.h > levelBounds.y + levelBounds.h)
+            {
+                outsideBricks++;
+            }
+        }
+
+        if (outsideBricks > 0)
+        {
+            SDL_Log("%s: %d of %d bricks are outside the level bounds", path_p, outsideBricks, (int)level.bricks.Size());
+            failedLevels++;
+            continue;
+        }
+
+        SDL_Log("%s: %d bricks, all inside the level bounds", path_p, (int)level.bricks.Size());
+    }
+
+    SDL_Log("levels checked: %d, failed: %d", (int)a_options.checkLevelPaths.size(), failedLevels);
+
+    return failedLevels == 0 ? 0 : 1;
+}
+
+}
+
+int
+main(int argc, char *argv[])
+{
+    Options options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (SDL_strcmp(argv[i], "--episodes") == 0 && hasValue)
+        {
+            options.episodeCount = SDL_atoi(argv[++i]);
+        }
+        else if (SDL_strcmp(argv[i], "--max-ticks") == 0 && hasValue)
+        {
+            options.maxTicks = SDL_strtoull(argv[++i], nullptr, 10);
+        }
+        else if (SDL_strcmp(argv[i], "--tick-rate") == 0 && hasValue)
+        {
+            // Episodes are simulated as fast as possible, there is no raw time between steps to simulate
+            const int tickRateHz = SDL_atoi(argv[++i]);
+            if (tickRateHz <= 0)
+            {
+                SDL_Log("--tick-rate needs a positive rate, the variable timestep of the game is not available headless");
+                return 1;
+            }
+            options.tickRateHz = (Uint32)tickRateHz;
+        }
+        else if (SDL_strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            options.seed = SDL_strtoull(argv[++i], nullptr, 10);
+        }
+        else if (SDL_strcmp(argv[i], "--balls") == 0 && hasValue)
+        {
+            options.extraBalls = SDL_atoi(argv[++i]);
+        }
+        else if (SDL_strcmp(argv[i], "--threads") == 0 && hasValue)
+        {
+            options.threadCount = SDL_atoi(argv[++i]);
+        }
+        else if (SDL_strcmp(argv[i], "--scaling") == 0)
+        {
+            options.measureScaling = true;
+        }
+        else if (SDL_strcmp(argv[i], "--stress-bricks") == 0 && hasValue)
+        {
+            options.stressLevelOptions.brickCount = (Uint32)SDL_strtoull(argv[++i], nullptr, 10);
+            options.stressLevel = true;
+        }
+        else if (SDL_strcmp(argv[i], "--stress-density") == 0 && hasValue)
+        {
+            options.stressLevelOptions.density = (float)SDL_atof(argv[++i]);
+        }
+        else if (SDL_strcmp(argv[i], "--stress-seed") == 0 && hasValue)
+        {
+            options.stressLevelOptions.seed = SDL_strtoull(argv[++i], nullptr, 10);
+        }
+        else if (SDL_strcmp(argv[i], "--record") == 0 && hasValue)
+        {
+            options.recordPath_p = argv[++i];
+        }
+        else if (SDL_strcmp(argv[i], "--replay") == 0 && hasValue)
+        {
+            options.replayPath_p = argv[++i];
+        }
+        else if (SDL_strcmp(argv[i], "--trace") == 0 && hasValue)
+        {
+            options.tracePath_p = argv[++i];
+        }
+        else if (SDL_strcmp(argv[i], "--check-level") == 0 && hasValue)
+        {
+            options.checkLevelPaths.push_back(argv[++i]);
+        }
+        else if (SDL_strcmp(argv[i], "--print-episodes") == 0)
+        {
+            options.printEpisodes = true;
+        }
+        else
+        {
+            SDL_Log("Usage: %s [--episodes N] [--max-ticks N] [--tick-rate HZ] [--seed N] [--balls N] [--threads N] [--scaling] [--stress-bricks N] [--stress-density D] [--stress-seed N] [--record FILE] [--replay FILE] [--trace FILE] [--check-level FILE] [--print-episodes]", argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.stressLevel && (options.recordPath_p || options.replayPath_p))
+    {
+        // Replays always rebuild the built-in level
+        SDL_Log("Stress levels can't be recorded or replayed");
+        return 1;
+    }
+
+    int result;
+    if (!options.checkLevelPaths.empty())
+    {
+        result = runLevelCheck(options);
+    }
+    else if (options.replayPath_p)
+    {
+        result = runReplay(options);
+    }
+    else
+    {
+        result = options.measureScaling ? runScaling(options) : runEpisodes(options);
+    }
+
+#ifdef ARKANOID_PROFILING
+    Profiler::Instance().LogSummary();
+    if (options.tracePath_p)
+    {
+        Profiler::Instance().WriteChromeTrace(options.tracePath_p);
+    }
+#else
+    if (options.tracePath_p)
+    {
+        SDL_Log("Profiling is not built in, configure with -DARKANOID_PROFILING=ON to write a trace");
+    }
+#endif
+
+    return result;
+}
@@ -1,48 +1,149 @@
-#define SDL_MAIN_USE_CALLBACKS 1
-#include <SDL3/SDL.h>
-#include <SDL3/SDL_main.h>
-
-#include "Game.hpp"
-#include "GeometryEngine.hpp"
-#include "LevelFactory.hpp"
-#include "Renderer.hpp"
-
-struct {
-    std::shared_ptr<Renderer> renderer_sp;
-    std::shared_ptr<LevelFactory> levelFactory_sp;
-    std::shared_ptr<GeometryEngine> geometryEngine_sp;
-    std::shared_ptr<Game> game_sp;
-} App;
-
-SDL_AppResult
-SDL_AppInit(void **appstate, int argc, char *argv[])
-{
-    App.renderer_sp = std::make_shared<Renderer>();
-    App.levelFactory_sp = std::make_shared<LevelFactory>();
-    App.geometryEngine_sp = std::make_shared<GeometryEngine>();
-    App.game_sp = std::make_shared<Game>(App.renderer_sp, App.levelFactory_sp, App.geometryEngine_sp);
-
-    SDL_SetAppMetadata("Arkanoid demo game", "0.0", "com.github.zuzi-m.arkanoid");
-
-    return App.renderer_sp->Init();
-}
-
-SDL_AppResult
-SDL_AppEvent(void *appstate, SDL_Event *event)
-{
-    return App.game_sp->HandleInput(appstate, event);
-}
-
-SDL_AppResult
-SDL_AppIterate(void *appstate)
-{
-    return App.game_sp->Iterate();
-}
-
-void
-SDL_AppQuit(void *appstate, SDL_AppResult result)
-{
-    /* SDL will clean up the window/renderer for us. */
-    App.game_sp.reset();
-    App.renderer_sp.reset();
+#define SDL_MAIN_USE_CALLBACKS 1
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_main.h>
+
+#include "Game.hpp"
+#include "GeometryEngine.hpp"
+#include "LevelFactory.hpp"
+#include "Profiler.hpp"
+#include "Renderer.hpp"
+
+struct {
+    std::shared_ptr<Renderer> renderer_sp;
+    std::shared_ptr<LevelFactory> levelFactory_sp;
+    std::shared_ptr<GeometryEngine> geometryEngine_sp;
+    std::shared_ptr<Game> game_sp;
+    const char* tracePath_p = "arkanoid_trace.json";
+} App;
+
+SDL_AppResult
+SDL_AppInit(void **appstate, int argc, char *argv[])
+{
+    App.renderer_sp = std::make_shared<Renderer>();
+    App.levelFactory_sp = std::make_shared<LevelFactory>();
+    App.geometryEngine_sp = std::make_shared<GeometryEngine>();
+    App.game_sp = std::make_shared<Game>(App.renderer_sp, App.levelFactory_sp, App.geometryEngine_sp);
+
+    bool vsync = false;
+    bool displayRefresh = false;
+    bool idleWait = false;
+    bool stressLevel = false;
+    StressLevelOptions stressLevelOptions;
+    for (int i = 1; i < argc; i++)
+    {
+        if (SDL_strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc)
+        {
+            App.game_sp->SetSimulationTickRate((Uint32)SDL_atoi(argv[++i]));
+        }
+        else if (SDL_strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            App.game_sp->StartRecording(argv[++i]);
+        }
+        else if (SDL_strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+        {
+            App.game_sp->SetLevelFile(argv[++i]);
+        }
+        else if (SDL_strcmp(argv[i], "--stress-bricks") == 0 && i + 1 < argc)
+        {
+            stressLevelOptions.brickCount = (Uint32)SDL_strtoull(argv[++i], nullptr, 10);
+            stressLevel = true;
+        }
+        else if (SDL_strcmp(argv[i], "--stress-density") == 0 && i + 1 < argc)
+        {
+            stressLevelOptions.density = (float)SDL_atof(argv[++i]);
+        }
+        else if (SDL_strcmp(argv[i], "--stress-seed") == 0 && i + 1 < argc)
+        {
+            stressLevelOptions.seed = (Uint64)SDL_strtoull(argv[++i], nullptr, 10);
+        }
+        else if (SDL_strcmp(argv[i], "--vsync") == 0)
+        {
+            vsync = true;
+        }
+        else if (SDL_strcmp(argv[i], "--display-refresh") == 0)
+        {
+            displayRefresh = true;
+        }
+        else if (SDL_strcmp(argv[i], "--idle-wait") == 0)
+        {
+            idleWait = true;
+        }
+        else if (SDL_strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            App.tracePath_p = argv[++i];
+        }
+    }
+
+    if (stressLevel)
+    {
+        App.game_sp->SetStressLevel(stressLevelOptions);
+    }
+
+    SDL_SetAppMetadata("Arkanoid demo game", "0.0", "com.github.zuzi-m.arkanoid");
+
+    const SDL_AppResult result = App.renderer_sp->Init();
+    if (result == SDL_APP_CONTINUE && vsync)
+    {
+        App.game_sp->SetVSync(true);
+    }
+    if (result == SDL_APP_CONTINUE && displayRefresh)
+    {
+        App.game_sp->SetMatchDisplayRefresh(true);
+    }
+    App.game_sp->SetIdleWait(idleWait);
+
+    return result;
+}
+
+SDL_AppResult
+SDL_AppEvent(void *appstate, SDL_Event *event)
+{
+    return App.game_sp->HandleInput(appstate, event);
+}
+
+SDL_AppResult
+SDL_AppIterate(void *appstate)
+{
+    return App.game_sp->Iterate();
+}
+
+void
+SDL_AppQuit(void *appstate, SDL_AppResult result)
+{
+    /* SDL will clean up the window/renderer for us. */
+    App.game_sp->Stop();
+
+    const BrickLayerCacheStats& brickLayerStats = App.renderer_sp->GetBrickLayerCacheStats();
+    SDL_Log("Brick layer cache: %llu hits, %llu partial updates (%llu regions), %llu misses",
+            (unsigned long long)brickLayerStats.hits,
+            (unsigned long long)brickLayerStats.partialUpdates,
+            (unsigned long long)brickLayerStats.dirtyRegions,
+            (unsigned long long)brickLayerStats.misses);
+
+    const FrameSchedulerStats frameStats = App.game_sp->GetFrameStats();
+    SDL_Log("Frames: %llu, %.1f FPS, average %.3f ms, jitter %.3f ms (variance %.4f ms^2), max deviation %.3f ms, wake-up delay %.3f ms, busy %.1f%%, missed deadlines %llu",
+            (unsigned long long)frameStats.frames,
+            frameStats.averageFps,
+            frameStats.averageFrameMS,
+            frameStats.frameJitterMS,
+            frameStats.frameTimeVarianceMS2,
+            frameStats.maxFrameDeviationMS,
+            frameStats.averageWakeUpDelayMS,
+            frameStats.busyFraction * 100.0,
+            (unsigned long long)frameStats.missedDeadlines);
+
+    const InputLatencyStats inputLatencyStats = App.game_sp->GetInputLatencyStats();
+    SDL_Log("Input to present latency: %llu inputs, average %.3f ms, jitter %.3f ms, max %.3f ms",
+            (unsigned long long)inputLatencyStats.inputs,
+            inputLatencyStats.averageMS,
+            inputLatencyStats.jitterMS,
+            inputLatencyStats.maxMS);
+
+#ifdef ARKANOID_PROFILING
+    Profiler::Instance().LogSummary();
+    Profiler::Instance().WriteChromeTrace(App.tracePath_p);
+#endif
+
+    App.game_sp.reset();
+    App.renderer_sp.reset();
 }
\ No newline at end of file